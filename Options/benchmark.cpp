@@ -0,0 +1,595 @@
+﻿#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "options.h"
+#include "chain_columns.h"
+#include "compact_book.h"
+#include "pricing_cache.h"
+#include "scenario_grid.h"
+
+/*
+*	Benchmarks of every FinancialCalculator and CalculateStrategy entry point (Google Benchmark)
+*
+*	-.Closed form pricers report ns/op, the chain pricers items/s over chains of 64 up to 65536 contracts (and the exception free
+*	overload with per contract statuses over a chain holding invalid contracts)
+*	-.Monte Carlo reports paths/s (items/s) per simulation mode and thread count, measured in wall time, and for small requests
+*	with the scratch taken from the global heap or from the thread's arena, per path payoff (Asian, barriers, lookbacks), for
+*	progressive runs down to a target standard error and for correlated baskets of 2 to 8 assets
+*	-.Submitted jobs report jobs/s of a burst of closed form quotes next to a Monte Carlo job on the shared scheduler (wall time)
+*	-.The implied volatility solver reports quotes/s over a chain, starting from its own guess or from the previous tick
+*	-.The mapped columnar chain reports the cost of a cold start (map and validate the file, then price it in place)
+*	-.Prepared options report the cost of a spot-only reprice (one contract, or a whole chain per tick)
+*	-.Large books report contracts/s priced from the OptionChain columns and from a CompactOptionBook of the same contracts
+*	-.The scenario grid reports contract scenarios/s of a 21 x 11 x 5 shock grid, on one thread and on every hardware thread (wall time)
+*	-.The pricing cache reports the cost of a hit (one hot contract) and of a miss-heavy stream (more contracts than capacity)
+*	-.Strategies report payoffs/s over a grid of spot prices (one call per spot, and the grid overload for the butterfly)
+*/
+
+namespace
+{
+	const BlackScholesParams bs_params{ 0.05, 100.0, 105.0, 0.75, 0.22, OptionType::Call, 0.0 };
+	const GreeksParams greeks_params{ 0.05, 100.0, 105.0, 0.75, 0.22, OptionType::Call, 0.0, 0.01 };
+	const FuturesParams futures_params{ 100.0, 0.05, 2.5 };
+
+	// Synthetic chain of the given size: strikes 50..150 around a 100 spot, expiries up to two years, calls and puts alternating
+	struct ChainData
+	{
+		std::vector<Price> underlying_price, strike_price;
+		std::vector<Time> time;
+		std::vector<Volatility> volatility;
+		std::vector<InterestRate> interest_rate;
+		std::vector<DividendYield> dividend_yield;
+		std::vector<OptionType> option_type;
+
+		explicit ChainData(const std::size_t size)
+			: underlying_price(size, 100.0), strike_price(size), time(size), volatility(size), interest_rate(size, 0.03), dividend_yield(size, 0.01), option_type(size)
+		{
+			for (std::size_t i{ 0 }; i < size; ++i)
+			{
+				strike_price[i] = 50.0 + 100.0 * static_cast<double>(i % 101) / 100.0;
+				time[i] = 0.05 + 2.0 * static_cast<double>(i % 37) / 36.0;
+				volatility[i] = 0.1 + 0.4 * static_cast<double>(i % 17) / 16.0;
+				option_type[i] = i % 2 == 0 ? OptionType::Call : OptionType::Put;
+			}
+		}
+
+		[[nodiscard]] OptionChain view() const noexcept
+		{
+			return { underlying_price.data(), strike_price.data(), time.data(), volatility.data(), interest_rate.data(), option_type.data(), dividend_yield.data(), underlying_price.size() };
+		}
+	};
+
+	std::vector<Price> spotGrid(const std::size_t size)
+	{
+		std::vector<Price> spots(size);
+		for (std::size_t i{ 0 }; i < size; ++i)
+		{
+			spots[i] = 50.0 + 100.0 * static_cast<double>(i) / static_cast<double>(size);
+		}
+		return spots;
+	}
+}
+
+static void BM_BlackScholes(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	BlackScholesParams params = bs_params;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(params);
+		benchmark::DoNotOptimize(financial_calculator.calculateBlackScholes(params));
+	}
+}
+BENCHMARK(BM_BlackScholes);
+
+static void BM_BlackScholesSpecialized(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	BlackScholesParams params = bs_params;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(params);
+		benchmark::DoNotOptimize(financial_calculator.calculateBlackScholes<OptionType::Call>(params));
+	}
+}
+BENCHMARK(BM_BlackScholesSpecialized);
+
+static void BM_BlackScholesApproximate(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	BlackScholesParams params = bs_params;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(params);
+		benchmark::DoNotOptimize(financial_calculator.calculateBlackScholesApproximate(params));
+	}
+}
+BENCHMARK(BM_BlackScholesApproximate);
+
+static void BM_PreparedReprice(benchmark::State& state)
+{
+	const PreparedOption prepared(bs_params);
+	Price spot = bs_params.underlying_price;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(spot);
+		benchmark::DoNotOptimize(prepared.reprice(spot));
+	}
+}
+BENCHMARK(BM_PreparedReprice);
+
+static void BM_CachedBlackScholes(benchmark::State& state)
+{
+	PricingCacheConfig config;
+	config.capacity = 1024;
+	PricingCache cache(config);
+	BlackScholesParams params = bs_params;
+	const std::size_t contracts = static_cast<std::size_t>(state.range(0));
+	std::size_t i{ 0 };
+	for (auto _ : state)
+	{
+		params.strike_price = 50.0 + static_cast<double>(i++ % contracts) * 0.01;
+		benchmark::DoNotOptimize(cache.calculateBlackScholes(params));
+	}
+}
+BENCHMARK(BM_CachedBlackScholes)->ArgName("contracts")->Arg(1)->Arg(1 << 16);
+
+static void BM_CachedGreeks(benchmark::State& state)
+{
+	PricingCacheConfig config;
+	config.capacity = 1024;
+	PricingCache cache(config);
+	GreeksParams params = greeks_params;
+	const std::size_t contracts = static_cast<std::size_t>(state.range(0));
+	std::size_t i{ 0 };
+	for (auto _ : state)
+	{
+		params.strike_price = 50.0 + static_cast<double>(i++ % contracts) * 0.01;
+		benchmark::DoNotOptimize(cache.calculateGreeks(params));
+	}
+}
+BENCHMARK(BM_CachedGreeks)->ArgName("contracts")->Arg(1)->Arg(1 << 16);
+
+static void BM_BlackScholesChain(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	const ChainData chain(static_cast<std::size_t>(state.range(0)));
+	std::vector<Price> prices(chain.underlying_price.size());
+	for (auto _ : state)
+	{
+		financial_calculator.calculateBlackScholes(chain.view(), prices.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BlackScholesChain)->RangeMultiplier(4)->Range(64, 1 << 16);
+
+// Large resident books: the OptionChain columns against the same contracts in a CompactOptionBook (float32 columns, type bits)
+static void BM_BookBlackScholes(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	const ChainData chain(static_cast<std::size_t>(state.range(0)));
+	const CompactOptionBook book(chain.view());
+	std::vector<Price> prices(chain.underlying_price.size());
+	for (auto _ : state)
+	{
+		if (state.range(1) == 0) financial_calculator.calculateBlackScholes(chain.view(), prices.data());
+		else book.calculateBlackScholes(prices.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BookBlackScholes)->ArgNames({ "contracts", "compact" })->ArgsProduct({ { 1 << 16, 1 << 20 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+
+// Exception free overload, a bad contract every 100 so the NaN pass runs too
+static void BM_BlackScholesChainStatus(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	ChainData chain(static_cast<std::size_t>(state.range(0)));
+	for (std::size_t i{ 0 }; i < chain.time.size(); i += 100)
+	{
+		chain.time[i] = 0.0;
+	}
+	std::vector<Price> prices(chain.underlying_price.size());
+	std::vector<PricingStatus> statuses(chain.underlying_price.size());
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(financial_calculator.calculateBlackScholes(chain.view(), prices.data(), statuses.data()));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BlackScholesChainStatus)->RangeMultiplier(4)->Range(64, 1 << 16);
+
+static void BM_MappedChainBlackScholes(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	const ChainData chain(static_cast<std::size_t>(state.range(0)));
+	const std::string path = "benchmark_chain.columns";
+	writeChainColumns(path, chain.view());
+	std::vector<Price> prices(chain.underlying_price.size());
+	for (auto _ : state)
+	{
+		const MappedOptionChain mapped(path);
+		financial_calculator.calculateBlackScholes(mapped.chain(), prices.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	std::remove(path.c_str());
+}
+BENCHMARK(BM_MappedChainBlackScholes)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+static void BM_PreparedChainReprice(benchmark::State& state)
+{
+	const ChainData chain(static_cast<std::size_t>(state.range(0)));
+	PreparedOptionChain prepared(chain.view());
+	std::vector<Price> prices(prepared.size());
+	Price spot{ 100.0 };
+	for (auto _ : state)
+	{
+		spot = spot == 100.0 ? 100.01 : 100.0;	// A new tick every iteration
+		prepared.reprice(spot, prices.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PreparedChainReprice)->RangeMultiplier(4)->Range(64, 1 << 16);
+
+// Risk grid of 21 spot x 11 volatility x 5 rate shocks over the chain, items are contract scenarios
+static void BM_ScenarioGrid(benchmark::State& state)
+{
+	ScenarioShocks shocks;
+	shocks.spot.clear();
+	shocks.volatility.clear();
+	shocks.interest_rate.clear();
+	for (int i{ -10 }; i <= 10; ++i) shocks.spot.push_back(0.01 * i);
+	for (int i{ -5 }; i <= 5; ++i) shocks.volatility.push_back(0.01 * i);
+	for (int i{ -2 }; i <= 2; ++i) shocks.interest_rate.push_back(0.0025 * i);
+
+	const ScenarioGrid grid(shocks);
+	const ChainData chain(static_cast<std::size_t>(state.range(0)));
+	std::vector<Price> cube(chain.underlying_price.size() * grid.scenarios());
+	for (auto _ : state)
+	{
+		grid.price(chain.view(), cube.data(), static_cast<std::size_t>(state.range(1)));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * static_cast<std::int64_t>(grid.scenarios()));
+}
+BENCHMARK(BM_ScenarioGrid)->ArgNames({ "contracts", "threads" })->Args({ 64, 1 })->Args({ 4096, 1 })->Args({ 4096, 0 })->UseRealTime();
+
+static void BM_Greek(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	GreeksParams params = greeks_params;
+	const auto greek = static_cast<Greeks>(state.range(0));
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(params);
+		benchmark::DoNotOptimize(financial_calculator.calculateGreeks(params, greek));
+	}
+}
+BENCHMARK(BM_Greek)->ArgName("greek")->DenseRange(static_cast<int>(Greeks::Delta), static_cast<int>(Greeks::Rho));
+
+static void BM_AllGreeks(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	GreeksParams params = greeks_params;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(params);
+		benchmark::DoNotOptimize(financial_calculator.calculateGreeks(params));
+	}
+}
+BENCHMARK(BM_AllGreeks);
+
+static void BM_GreeksChain(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	const ChainData chain(static_cast<std::size_t>(state.range(0)));
+	const std::size_t size = chain.underlying_price.size();
+	std::vector<double> price(size), delta(size), gamma(size), theta(size), vega(size), rho(size);
+	const OptionGreeksChain greeks{ price.data(), delta.data(), gamma.data(), theta.data(), vega.data(), rho.data() };
+	for (auto _ : state)
+	{
+		financial_calculator.calculateGreeks(chain.view(), greeks);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GreeksChain)->RangeMultiplier(4)->Range(64, 1 << 16);
+
+// Implied volatilities of a chain quoted at its own Black-Scholes prices, cold (solver's own guess) or warm (previous tick 1% off)
+static void BM_ImpliedVolatilityChain(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	const ChainData chain(static_cast<std::size_t>(state.range(0)));
+	const std::size_t size = chain.underlying_price.size();
+	std::vector<Price> paid_prices(size);
+	financial_calculator.calculateBlackScholes(chain.view(), paid_prices.data());
+
+	std::vector<Volatility> starts(size, 0.0), volatilities(size);
+	if (state.range(1) != 0)
+	{
+		for (std::size_t i{ 0 }; i < size; ++i) starts[i] = chain.volatility[i] * 1.01;
+	}
+	OptionChain quotes = chain.view();
+	quotes.volatility = starts.data();
+
+	for (auto _ : state)
+	{
+		financial_calculator.calculateImpliedVolatility(quotes, paid_prices.data(), volatilities.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ImpliedVolatilityChain)->ArgNames({ "size", "warm" })->ArgsProduct({ { 1 << 10, 1 << 16 }, { 0, 1 } });
+
+static void BM_Futures(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	FuturesParams params = futures_params;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(params);
+		benchmark::DoNotOptimize(financial_calculator.calculateFutures(params));
+	}
+}
+BENCHMARK(BM_Futures);
+
+// Arguments: worker threads, simulation mode (0 = daily steps, 1 = terminal only)
+static void BM_MonteCarlo(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	MonteCarloParams params{ 0, 0.05, 100.0, 105.0, 1.0, 0.22, OptionType::Call, 0.0 };
+	params.number_of_threads = static_cast<std::size_t>(state.range(0));
+	params.simulation_mode = static_cast<SimulationMode>(state.range(1));
+	params.number_of_simulations = params.simulation_mode == SimulationMode::TerminalOnly ? 1'000'000 : 10'000;
+	params.seed = 42;
+	params.random_engine = RandomEngine::Xoshiro256;
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(financial_calculator.calculateMonteCarlo(params));
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(params.number_of_simulations));
+}
+
+static void monteCarloArguments(benchmark::internal::Benchmark* benchmark)
+{
+	const int hardware_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	for (const int mode : { static_cast<int>(SimulationMode::DailySteps), static_cast<int>(SimulationMode::TerminalOnly) })
+	{
+		for (int threads{ 1 }; threads < hardware_threads; threads *= 2)
+		{
+			benchmark->Args({ threads, mode });
+		}
+		benchmark->Args({ hardware_threads, mode });
+	}
+}
+BENCHMARK(BM_MonteCarlo)->ArgNames({ "threads", "mode" })->Apply(monteCarloArguments)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Arguments: random engine, sampling method (terminal-only paths so the generator dominates)
+static void BM_MonteCarloSampling(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	MonteCarloParams params{ 1 << 20, 0.05, 100.0, 105.0, 1.0, 0.22, OptionType::Call, 0.0 };
+	params.seed = 42;
+	params.simulation_mode = SimulationMode::TerminalOnly;
+	params.random_engine = static_cast<RandomEngine>(state.range(0));
+	params.sampling_method = static_cast<SamplingMethod>(state.range(1));
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(financial_calculator.calculateMonteCarlo(params));
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(params.number_of_simulations));
+}
+BENCHMARK(BM_MonteCarloSampling)->ArgNames({ "engine", "sampling" })
+	->Args({ static_cast<int>(RandomEngine::MersenneTwister), static_cast<int>(SamplingMethod::PseudoRandom) })
+	->Args({ static_cast<int>(RandomEngine::Xoshiro256), static_cast<int>(SamplingMethod::PseudoRandom) })
+	->Args({ static_cast<int>(RandomEngine::Philox), static_cast<int>(SamplingMethod::PseudoRandom) })
+	->Args({ static_cast<int>(RandomEngine::Xoshiro256), static_cast<int>(SamplingMethod::Sobol) })
+	->Unit(benchmark::kMillisecond);
+
+// Argument: path payoff (daily steps), the knock-out barriers drop their dead paths from the step loop
+static void BM_MonteCarloPathPayoff(benchmark::State& state)
+{
+	FinancialCalculator financial_calculator;
+	MonteCarloParams params{ 20'000, 0.05, 100.0, 100.0, 1.0, 0.22, OptionType::Call, 0.0 };
+	params.seed = 42;
+	params.random_engine = RandomEngine::Xoshiro256;
+	params.path_payoff = static_cast<PathPayoff>(state.range(0));
+	params.barrier = params.path_payoff == PathPayoff::DownAndOut || params.path_payoff == PathPayoff::DownAndIn ? 90.0 : 120.0;
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(financial_calculator.calculateMonteCarlo(params));
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(params.number_of_simulations));
+}
+BENCHMARK(BM_MonteCarloPathPayoff)->ArgName("payoff")->DenseRange(static_cast<int>(PathPayoff::European), static_cast<int>(PathPayoff::LookbackFloatingStrike))
+	->Unit(benchmark::kMillisecond);
+
+// Argument: scratch resource (0 = global heap, 1 = scratch arena of the thread), small single-threaded requests where the allocations matter
+static void BM_MonteCarloScratch(benchmark::State& state)
+{
+	const FinancialCalculator financial_calculator(state.range(0) == 0 ? std::pmr::new_delete_resource() : &threadScratchArena());
+	MonteCarloParams params{ 4096, 0.05, 100.0, 105.0, 1.0, 0.22, OptionType::Call, 0.0 };
+	params.seed = 42;
+	params.number_of_threads = 1;
+	params.simulation_mode = SimulationMode::TerminalOnly;
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(financial_calculator.calculateMonteCarlo(params));
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(params.number_of_simulations));
+}
+BENCHMARK(BM_MonteCarloScratch)->ArgName("arena")->Arg(0)->Arg(1);
+
+// Progressive Monte Carlo down to a target standard error (5 cents, 1 cent), paths/s over the paths it needed
+static void BM_MonteCarloProgressive(benchmark::State& state)
+{
+	const FinancialCalculator financial_calculator;
+	MonteCarloParams params{ 0, 0.05, 100.0, 105.0, 1.0, 0.22, OptionType::Call, 0.0 };
+	params.seed = 42;
+	params.simulation_mode = SimulationMode::TerminalOnly;
+	params.target_standard_error = 1.0 / static_cast<double>(state.range(0));
+
+	std::size_t paths{ 0 };
+	for (auto _ : state)
+	{
+		const MonteCarloResult result = financial_calculator.calculateMonteCarloEstimate(params);
+		paths += result.number_of_paths;
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(paths));
+}
+BENCHMARK(BM_MonteCarloProgressive)->ArgName("1/target")->Arg(20)->Arg(100);
+
+// Argument: assets of the basket (equal weights, 0.5 pairwise correlation), daily steps, paths/s
+static void BM_MonteCarloBasket(benchmark::State& state)
+{
+	const FinancialCalculator financial_calculator;
+	const std::size_t assets = static_cast<std::size_t>(state.range(0));
+	MonteCarloParams params{ 20'000, 0.05, 0.0, 100.0, 1.0, 0.0, OptionType::Call, 0.0 };
+	params.seed = 42;
+	params.random_engine = RandomEngine::Xoshiro256;
+	params.assets.assign(assets, BasketAsset{ 100.0, 0.22, 1.0 / static_cast<double>(assets) });
+	params.correlation.assign(assets * assets, 0.5);
+	for (std::size_t a{ 0 }; a < assets; ++a) params.correlation[a * assets + a] = 1.0;
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(financial_calculator.calculateMonteCarlo(params));
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(params.number_of_simulations));
+}
+BENCHMARK(BM_MonteCarloBasket)->ArgName("assets")->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+
+// Mixed workload submitted to the shared scheduler: a burst of closed form quotes next to one Monte Carlo job, every future waited on
+static void BM_SubmitMixed(benchmark::State& state)
+{
+	const FinancialCalculator financial_calculator;
+	const auto quotes = static_cast<std::size_t>(state.range(0));
+	MonteCarloParams params{ 65536, 0.05, 100.0, 105.0, 1.0, 0.22, OptionType::Call, 0.0 };
+	params.seed = 42;
+	params.simulation_mode = SimulationMode::TerminalOnly;
+
+	std::vector<std::future<Price>> prices(quotes);
+	for (auto _ : state)
+	{
+		std::future<MonteCarloResult> simulation = financial_calculator.submitMonteCarlo(params);
+		for (std::size_t i{ 0 }; i < quotes; ++i)
+		{
+			BlackScholesParams quote = bs_params;
+			quote.strike_price = 50.0 + static_cast<double>(i % 100);
+			prices[i] = financial_calculator.submitBlackScholes(quote);
+		}
+
+		for (auto& price : prices) benchmark::DoNotOptimize(price.get());
+		benchmark::DoNotOptimize(simulation.get());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(quotes + 1));
+}
+BENCHMARK(BM_SubmitMixed)->Arg(64)->Arg(4096)->UseRealTime();
+
+static void BM_PutSpread(benchmark::State& state)
+{
+	const CalculateStrategy strategy;
+	const Option long_put(110.0, 12.0, OptionType::Put), short_put(90.0, 3.0, OptionType::Put);
+	const auto spots = spotGrid(static_cast<std::size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		for (const auto spot : spots) benchmark::DoNotOptimize(strategy.getPutSpread(long_put, short_put, spot));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PutSpread)->Arg(10'000);
+
+static void BM_CallSpread(benchmark::State& state)
+{
+	const CalculateStrategy strategy;
+	const Option long_call(90.0, 12.0, OptionType::Call), short_call(110.0, 3.0, OptionType::Call);
+	const auto spots = spotGrid(static_cast<std::size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		for (const auto spot : spots) benchmark::DoNotOptimize(strategy.getCallSpread(long_call, short_call, spot));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CallSpread)->Arg(10'000);
+
+static void BM_Butterfly(benchmark::State& state)
+{
+	const CalculateStrategy strategy;
+	const Option wing1(90.0, 12.0, OptionType::Call), body(100.0, 6.0, OptionType::Call), wing2(110.0, 2.5, OptionType::Call);
+	const auto spots = spotGrid(static_cast<std::size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		for (const auto spot : spots) benchmark::DoNotOptimize(strategy.getButterfly(wing1, body, wing2, spot));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Butterfly)->Arg(10'000);
+
+static void BM_Strangle(benchmark::State& state)
+{
+	const CalculateStrategy strategy;
+	const Option put(90.0, 3.0, OptionType::Put), call(110.0, 3.0, OptionType::Call);
+	const auto spots = spotGrid(static_cast<std::size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		for (const auto spot : spots) benchmark::DoNotOptimize(strategy.getStrangle(put, call, spot));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Strangle)->Arg(10'000);
+
+static void BM_Straddle(benchmark::State& state)
+{
+	const CalculateStrategy strategy;
+	const Option put(100.0, 6.0, OptionType::Put), call(100.0, 6.0, OptionType::Call);
+	const auto spots = spotGrid(static_cast<std::size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		for (const auto spot : spots) benchmark::DoNotOptimize(strategy.getStraddle(put, call, spot));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Straddle)->Arg(10'000);
+
+static void BM_ButterflyGrid(benchmark::State& state)
+{
+	const CalculateStrategy strategy;
+	const Option wing1(90.0, 12.0, OptionType::Call), body(100.0, 6.0, OptionType::Call), wing2(110.0, 2.5, OptionType::Call);
+	const auto spots = spotGrid(static_cast<std::size_t>(state.range(0)));
+	std::vector<StrategyPayoff> payoffs(spots.size());
+	for (auto _ : state)
+	{
+		strategy.getButterfly(wing1, body, wing2, spots.data(), payoffs.data(), spots.size());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ButterflyGrid)->Arg(10'000);
+
+static void BM_IronCondorGreeks(benchmark::State& state)
+{
+	const auto condor = CalculateStrategy::makeIronCondor(Option(80.0, 1.0, OptionType::Put), Option(90.0, 2.5, OptionType::Put),
+		Option(110.0, 2.7, OptionType::Call), Option(120.0, 1.1, OptionType::Call));
+	const StrategyMarket market{ 0.03, 101.0, 0.7, 0.25, 0.01 };
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(condor.calculateGreeks(market));
+	}
+}
+BENCHMARK(BM_IronCondorGreeks);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,112 @@
+﻿#include "chain_columns.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+	// @columnAt : Start of a column of records elements of type T, after checking it lies within the image and is aligned
+	template<typename T>
+	[[nodiscard]] const T* columnAt(const char* data, const std::size_t size, const std::uint64_t offset, const std::uint64_t records, const char* name)
+	{
+		if (offset % CHAIN_COLUMNS_ALIGNMENT != 0) throw std::runtime_error(std::string("[!] Misaligned ") + name + " column");
+		if (offset > size || records > (size - offset) / sizeof(T)) throw std::runtime_error(std::string("[!] The ") + name + " column is truncated");
+
+		return reinterpret_cast<const T*>(data + offset);
+	}
+
+	[[nodiscard]] std::uint64_t alignOffset(const std::uint64_t offset) noexcept
+	{
+		return (offset + CHAIN_COLUMNS_ALIGNMENT - 1) / CHAIN_COLUMNS_ALIGNMENT * CHAIN_COLUMNS_ALIGNMENT;
+	}
+}
+
+MappedOptionChain::MappedOptionChain(const std::string& path)
+	: file_(path)
+{
+	// The mapping starts on a page boundary, so the aligned offsets of the columns are aligned in memory too
+	chain_ = viewChainColumns(file_.data(), file_.size());
+}
+
+[[nodiscard]] bool isChainColumnsFile(const char* data, const std::size_t size) noexcept
+{
+	return size >= sizeof(CHAIN_COLUMNS_MAGIC) && std::memcmp(data, CHAIN_COLUMNS_MAGIC, sizeof(CHAIN_COLUMNS_MAGIC)) == 0;
+}
+
+[[nodiscard]] OptionChain viewChainColumns(const char* data, const std::size_t size)
+{
+	if (data == nullptr || size < sizeof(ChainColumnsHeader)) throw std::runtime_error("[!] Truncated columnar chain header");
+	if (!isChainColumnsFile(data, size)) throw std::runtime_error("[!] Not a columnar chain file");
+	if (reinterpret_cast<std::uintptr_t>(data) % CHAIN_COLUMNS_ALIGNMENT != 0) throw std::invalid_argument("[!] The columnar chain image must be aligned on CHAIN_COLUMNS_ALIGNMENT");
+
+	ChainColumnsHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (header.version != CHAIN_COLUMNS_VERSION) throw std::runtime_error("[!] Unsupported columnar chain version " + std::to_string(header.version));
+
+	OptionChain chain;
+	chain.size = static_cast<std::size_t>(header.records);
+	chain.underlying_price = columnAt<Price>(data, size, header.underlying_price_offset, header.records, "underlying price");
+	chain.strike_price = columnAt<Price>(data, size, header.strike_price_offset, header.records, "strike price");
+	chain.time = columnAt<Time>(data, size, header.time_offset, header.records, "time");
+	chain.volatility = columnAt<Volatility>(data, size, header.volatility_offset, header.records, "volatility");
+	chain.interest_rate = columnAt<InterestRate>(data, size, header.interest_rate_offset, header.records, "interest rate");
+	if (header.flags & CHAIN_COLUMNS_DIVIDENDS)
+	{
+		chain.dividend_yield = columnAt<DividendYield>(data, size, header.dividend_yield_offset, header.records, "dividend yield");
+	}
+
+	// Only 0 / 1 are valid OptionType values, the scan is one byte per contract
+	const auto* option_types = columnAt<std::uint8_t>(data, size, header.option_type_offset, header.records, "option type");
+	if (!std::all_of(option_types, option_types + chain.size, [](const std::uint8_t type) { return type <= 1; }))
+	{
+		throw std::runtime_error("[!] Invalid option type in the columnar chain");
+	}
+	chain.option_type = reinterpret_cast<const OptionType*>(option_types);
+
+	return chain;
+}
+
+void writeChainColumns(const std::string& path, const OptionChain& chain)
+{
+	std::ofstream output(path, std::ios::binary | std::ios::trunc);
+	if (!output) throw std::runtime_error("[!] Can't open " + path + " for writing");
+
+	const std::uint64_t records = chain.size;
+	const std::uint64_t double_column = records * sizeof(double);
+
+	ChainColumnsHeader header;
+	std::memcpy(header.magic, CHAIN_COLUMNS_MAGIC, sizeof(header.magic));
+	header.version = CHAIN_COLUMNS_VERSION;
+	header.flags = chain.dividend_yield != nullptr ? CHAIN_COLUMNS_DIVIDENDS : 0;
+	header.records = records;
+	header.underlying_price_offset = alignOffset(sizeof(header));
+	header.strike_price_offset = alignOffset(header.underlying_price_offset + double_column);
+	header.time_offset = alignOffset(header.strike_price_offset + double_column);
+	header.volatility_offset = alignOffset(header.time_offset + double_column);
+	header.interest_rate_offset = alignOffset(header.volatility_offset + double_column);
+	header.dividend_yield_offset = chain.dividend_yield != nullptr ? alignOffset(header.interest_rate_offset + double_column) : 0;
+	header.option_type_offset = alignOffset((chain.dividend_yield != nullptr ? header.dividend_yield_offset : header.interest_rate_offset) + double_column);
+
+	std::uint64_t position{ 0 };
+	const auto writeColumn = [&](const std::uint64_t offset, const void* column, const std::uint64_t bytes)
+	{
+		static constexpr char padding[CHAIN_COLUMNS_ALIGNMENT]{};
+		output.write(padding, static_cast<std::streamsize>(offset - position));
+		output.write(static_cast<const char*>(column), static_cast<std::streamsize>(bytes));
+		position = offset + bytes;
+	};
+
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	position = sizeof(header);
+	writeColumn(header.underlying_price_offset, chain.underlying_price, double_column);
+	writeColumn(header.strike_price_offset, chain.strike_price, double_column);
+	writeColumn(header.time_offset, chain.time, double_column);
+	writeColumn(header.volatility_offset, chain.volatility, double_column);
+	writeColumn(header.interest_rate_offset, chain.interest_rate, double_column);
+	if (chain.dividend_yield != nullptr) writeColumn(header.dividend_yield_offset, chain.dividend_yield, double_column);
+	writeColumn(header.option_type_offset, chain.option_type, records * sizeof(OptionType));
+
+	if (!output) throw std::runtime_error("[!] Can't write " + path);
+}
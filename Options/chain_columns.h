@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "options.h"
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <string>
+
+/*
+*	Columnar binary chain format: the file is the OptionChain struct-of-arrays laid out on disk, so a mapped file is priced in place
+*	by the batch pricers without any parsing or copy
+*
+*	-.Layout: a ChainColumnsHeader, then one column per OptionChain field, each starting at a CHAIN_COLUMNS_ALIGNMENT byte offset
+*	(doubles for the numeric fields, one byte per OptionType, 0 Call / 1 Put), native endianness
+*	-.The dividend column is optional (CHAIN_COLUMNS_DIVIDENDS flag), without it the mapped chain has dividend_yield == nullptr
+*	-.Loading checks the header and the bounds of every column, then only scans the option type bytes, the numeric columns are
+*	read from the page cache on demand the first time the pricers touch them
+*/
+
+// Header of the columnar format, every offset is in bytes from the start of the file
+struct ChainColumnsHeader
+{
+	char magic[8]{};
+	std::uint32_t version{};
+	std::uint32_t flags{};
+	std::uint64_t records{};
+	std::uint64_t underlying_price_offset{};
+	std::uint64_t strike_price_offset{};
+	std::uint64_t time_offset{};
+	std::uint64_t volatility_offset{};
+	std::uint64_t interest_rate_offset{};
+	std::uint64_t dividend_yield_offset{};	// 0 without the CHAIN_COLUMNS_DIVIDENDS flag
+	std::uint64_t option_type_offset{};
+};
+
+static_assert(sizeof(ChainColumnsHeader) == 80, "[!] ChainColumnsHeader must stay 80 bytes, it is an on-disk layout");
+static_assert(sizeof(OptionType) == 1, "[!] The option type column is mapped as OptionType, it must stay one byte");
+
+constexpr char CHAIN_COLUMNS_MAGIC[8] = { 'F', 'C', 'C', 'O', 'L', 'U', 'M', 'N' };
+constexpr std::uint32_t CHAIN_COLUMNS_VERSION = 1;
+constexpr std::uint32_t CHAIN_COLUMNS_DIVIDENDS = 1;
+constexpr std::size_t CHAIN_COLUMNS_ALIGNMENT = 64;	// A cache line, and the widest vector loads of the kernels
+
+/*
+	MappedOptionChain : Columnar chain file mapped read-only, chain() points straight into the mapping
+	-.The chain stays valid as long as the MappedOptionChain is alive, it is move-only like the mapping
+	-.Throws on a file that is not in the columnar format, of another version, truncated or with an invalid option type
+*/
+class MappedOptionChain
+{
+public:
+	explicit MappedOptionChain(const std::string& path);
+
+	[[nodiscard]] inline const OptionChain& chain() const noexcept { return chain_; }
+	[[nodiscard]] inline std::size_t size() const noexcept { return chain_.size; }
+
+private:
+	MappedFile file_;
+	OptionChain chain_{};
+};
+
+// @isChainColumnsFile : True when the size bytes at data start with CHAIN_COLUMNS_MAGIC
+[[nodiscard]] bool isChainColumnsFile(const char* data, std::size_t size) noexcept;
+
+// @viewChainColumns : Validates a columnar chain image of size bytes (data aligned on CHAIN_COLUMNS_ALIGNMENT) and returns the chain pointing into it
+[[nodiscard]] OptionChain viewChainColumns(const char* data, std::size_t size);
+
+// @writeChainColumns : Writes a chain in the columnar format (the dividend column is written only when chain.dividend_yield is set)
+void writeChainColumns(const std::string& path, const OptionChain& chain);
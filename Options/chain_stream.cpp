@@ -0,0 +1,547 @@
+﻿#include "chain_stream.h"
+#include "chain_columns.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// One chunk of the ring: input columns and result columns of up to capacity records
+	struct ChainChunk
+	{
+		std::vector<Price> underlying_price, strike_price;
+		std::vector<Time> time;
+		std::vector<Volatility> volatility;
+		std::vector<InterestRate> interest_rate;
+		std::vector<DividendYield> dividend_yield;
+		std::vector<OptionType> option_type;
+		std::vector<double> price, delta, gamma, theta, vega, rho;
+		OptionChain mapped{};	// Slice of a mapped columnar file priced in place of the input columns (when set)
+		std::size_t size{};
+
+		ChainChunk(const std::size_t capacity, const bool greeks)
+			: underlying_price(capacity), strike_price(capacity), time(capacity), volatility(capacity), interest_rate(capacity), dividend_yield(capacity),
+			option_type(capacity), price(capacity), delta(greeks ? capacity : 0), gamma(greeks ? capacity : 0), theta(greeks ? capacity : 0),
+			vega(greeks ? capacity : 0), rho(greeks ? capacity : 0) {}
+
+		[[nodiscard]] OptionChain view() const noexcept
+		{
+			if (mapped.underlying_price != nullptr) return mapped;
+			return { underlying_price.data(), strike_price.data(), time.data(), volatility.data(), interest_rate.data(), option_type.data(), dividend_yield.data(), size };
+		}
+
+		[[nodiscard]] OptionGreeksChain greeks() noexcept
+		{
+			return { price.data(), delta.data(), gamma.data(), theta.data(), vega.data(), rho.data() };
+		}
+	};
+
+	// Hand-off between two stages, pop() blocks until a chunk is available and returns nullptr once the queue is closed and drained
+	// (or right away after an abort)
+	class ChunkQueue
+	{
+	private:
+		std::mutex mutex_{};
+		std::condition_variable ready_{};
+		std::deque<ChainChunk*> chunks_{};
+		bool closed_{};
+		bool aborted_{};
+
+	public:
+		void push(ChainChunk* chunk)
+		{
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				chunks_.push_back(chunk);
+			}
+			ready_.notify_one();
+		}
+
+		[[nodiscard]] ChainChunk* pop()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			ready_.wait(lock, [this] { return !chunks_.empty() || closed_ || aborted_; });
+			if (aborted_ || chunks_.empty()) return nullptr;
+
+			ChainChunk* chunk = chunks_.front();
+			chunks_.pop_front();
+			return chunk;
+		}
+
+		void close(const bool abort = false)
+		{
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				closed_ = true;
+				aborted_ = aborted_ || abort;
+			}
+			ready_.notify_all();
+		}
+	};
+
+	[[nodiscard]] bool isRecordsFile(const char* data, const std::size_t size) noexcept
+	{
+		return size >= sizeof(CHAIN_RECORDS_MAGIC) && std::memcmp(data, CHAIN_RECORDS_MAGIC, sizeof(CHAIN_RECORDS_MAGIC)) == 0;
+	}
+
+	// @CsvChunkReader : Parses the lines of a mapped CSV file into chunks, releasing the pages behind it
+	class CsvChunkReader
+	{
+	private:
+		MappedFile& file_;
+		const char* position_{};
+		const char* end_{};
+		std::uint64_t line_{ 0 };
+
+		[[noreturn]] void fail() const
+		{
+			throw std::runtime_error("[!] Malformed CSV record at line " + std::to_string(line_));
+		}
+
+		static void skipBlanks(const char*& cursor, const char* line_end) noexcept
+		{
+			while (cursor < line_end && (*cursor == ' ' || *cursor == '\t')) ++cursor;
+		}
+
+		// @nextField : Moves cursor past the separator of the current field, returns false at the end of the line
+		[[nodiscard]] static bool nextField(const char*& cursor, const char* line_end) noexcept
+		{
+			skipBlanks(cursor, line_end);
+			if (cursor < line_end && *cursor == ',')
+			{
+				++cursor;
+				return true;
+			}
+			return false;
+		}
+
+		[[nodiscard]] double parseNumber(const char*& cursor, const char* line_end) const
+		{
+			skipBlanks(cursor, line_end);
+			if (cursor < line_end && *cursor == '+') ++cursor;	// from_chars doesn't take an explicit plus sign
+
+			double value{};
+			const auto [next, error] = std::from_chars(cursor, line_end, value);
+			if (error != std::errc()) fail();
+			cursor = next;
+			return value;
+		}
+
+		[[nodiscard]] OptionType parseOptionType(const char*& cursor, const char* line_end) const
+		{
+			skipBlanks(cursor, line_end);
+			const char* token = cursor;
+			while (cursor < line_end && *cursor != ',' && *cursor != ' ' && *cursor != '\t') ++cursor;
+
+			const auto matches = [token, length = static_cast<std::size_t>(cursor - token)](const char* word)
+			{
+				if (std::strlen(word) != length) return false;
+				for (std::size_t i{ 0 }; i < length; ++i)
+				{
+					if ((token[i] | 0x20) != word[i]) return false;	// ASCII lower case
+				}
+				return true;
+			};
+
+			if (matches("call") || matches("c")) return OptionType::Call;
+			if (matches("put") || matches("p")) return OptionType::Put;
+			fail();
+		}
+
+	public:
+		explicit CsvChunkReader(MappedFile& file)
+			: file_(file), position_(file.data()), end_(file.data() + file.size())
+		{
+			if (end_ - position_ >= 3 && std::memcmp(position_, "\xEF\xBB\xBF", 3) == 0) position_ += 3;	// UTF-8 BOM
+
+			// A first line starting with a letter is a header
+			const char* first = position_;
+			while (first < end_ && (*first == ' ' || *first == '\t' || *first == '\r' || *first == '\n')) ++first;
+			if (first < end_ && ((*first | 0x20) >= 'a' && (*first | 0x20) <= 'z'))
+			{
+				const char* line_end = static_cast<const char*>(std::memchr(first, '\n', static_cast<std::size_t>(end_ - first)));
+				line_ += static_cast<std::uint64_t>(std::count(position_, first, '\n')) + 1;
+				position_ = line_end != nullptr ? line_end + 1 : end_;
+			}
+		}
+
+		[[nodiscard]] inline bool done() const noexcept { return position_ >= end_; }
+
+		// @read : Fills chunk with the next records (up to capacity), returns how many were read
+		[[nodiscard]] std::size_t read(ChainChunk& chunk, const std::size_t capacity)
+		{
+			std::size_t size{ 0 };
+			while (size < capacity && position_ < end_)
+			{
+				const char* newline = static_cast<const char*>(std::memchr(position_, '\n', static_cast<std::size_t>(end_ - position_)));
+				const char* line_end = newline != nullptr ? newline : end_;
+				const char* cursor = position_;
+				position_ = newline != nullptr ? newline + 1 : end_;
+				++line_;
+
+				const char* content_end = line_end;
+				if (content_end > cursor && content_end[-1] == '\r') --content_end;
+				skipBlanks(cursor, content_end);
+				if (cursor == content_end) continue;	// Blank line
+
+				chunk.underlying_price[size] = parseNumber(cursor, content_end);
+				if (!nextField(cursor, content_end)) fail();
+				chunk.strike_price[size] = parseNumber(cursor, content_end);
+				if (!nextField(cursor, content_end)) fail();
+				chunk.time[size] = parseNumber(cursor, content_end);
+				if (!nextField(cursor, content_end)) fail();
+				chunk.volatility[size] = parseNumber(cursor, content_end);
+				if (!nextField(cursor, content_end)) fail();
+				chunk.interest_rate[size] = parseNumber(cursor, content_end);
+				if (!nextField(cursor, content_end)) fail();
+				chunk.option_type[size] = parseOptionType(cursor, content_end);
+				chunk.dividend_yield[size] = nextField(cursor, content_end) ? parseNumber(cursor, content_end) : 0.0;
+
+				skipBlanks(cursor, content_end);
+				if (cursor != content_end) fail();
+				++size;
+			}
+
+			file_.releaseBefore(static_cast<std::size_t>(position_ - file_.data()));
+			return size;
+		}
+	};
+
+	// @RecordChunkReader : Copies the rows of a mapped binary records file into chunks, releasing the pages behind it
+	class RecordChunkReader
+	{
+	private:
+		MappedFile& file_;
+		std::uint64_t next_{ 0 };
+		std::uint64_t records_{ 0 };
+
+		[[nodiscard]] const PackedOptionRecord* record(const std::uint64_t index) const noexcept
+		{
+			return reinterpret_cast<const PackedOptionRecord*>(file_.data() + sizeof(ChainRecordsHeader)) + index;
+		}
+
+	public:
+		explicit RecordChunkReader(MappedFile& file)
+			: file_(file)
+		{
+			ChainRecordsHeader header;
+			if (file.size() < sizeof(header)) throw std::runtime_error("[!] Truncated binary records header");
+			std::memcpy(&header, file.data(), sizeof(header));
+
+			if (header.version != CHAIN_RECORDS_VERSION) throw std::runtime_error("[!] Unsupported binary records version " + std::to_string(header.version));
+			if (header.record_size != sizeof(PackedOptionRecord)) throw std::runtime_error("[!] Unexpected binary record size " + std::to_string(header.record_size));
+			if ((file.size() - sizeof(header)) / sizeof(PackedOptionRecord) < header.records) throw std::runtime_error("[!] The binary records file is truncated");
+
+			records_ = header.records;
+		}
+
+		[[nodiscard]] inline bool done() const noexcept { return next_ >= records_; }
+
+		[[nodiscard]] std::size_t read(ChainChunk& chunk, const std::size_t capacity)
+		{
+			const std::size_t size = static_cast<std::size_t>(std::min<std::uint64_t>(capacity, records_ - next_));
+			for (std::size_t i{ 0 }; i < size; ++i)
+			{
+				PackedOptionRecord row;
+				std::memcpy(&row, record(next_ + i), sizeof(row));	// The mapping gives no alignment guarantee past the header
+
+				chunk.underlying_price[i] = row.underlying_price;
+				chunk.strike_price[i] = row.strike_price;
+				chunk.time[i] = row.time;
+				chunk.volatility[i] = row.volatility;
+				chunk.interest_rate[i] = row.interest_rate;
+				chunk.dividend_yield[i] = row.dividend_yield;
+				if (row.option_type > 1) throw std::runtime_error("[!] Invalid option type in binary record " + std::to_string(next_ + i));
+				chunk.option_type[i] = row.option_type == 0 ? OptionType::Call : OptionType::Put;
+			}
+
+			next_ += size;
+			file_.releaseBefore(sizeof(ChainRecordsHeader) + static_cast<std::size_t>(next_) * sizeof(PackedOptionRecord));
+			return size;
+		}
+	};
+
+	// @ColumnChunkReader : Hands out slices of a mapped columnar file, the chunks point into the mapping so nothing is copied
+	class ColumnChunkReader
+	{
+	private:
+		OptionChain chain_{};
+		std::size_t next_{ 0 };
+
+	public:
+		explicit ColumnChunkReader(const MappedFile& file)
+			: chain_(viewChainColumns(file.data(), file.size())) {}
+
+		[[nodiscard]] inline bool done() const noexcept { return next_ >= chain_.size; }
+
+		[[nodiscard]] std::size_t read(ChainChunk& chunk, const std::size_t capacity) noexcept
+		{
+			const std::size_t size = std::min(capacity, chain_.size - next_);
+			chunk.mapped = { chain_.underlying_price + next_, chain_.strike_price + next_, chain_.time + next_, chain_.volatility + next_, chain_.interest_rate + next_,
+				chain_.option_type + next_, chain_.dividend_yield != nullptr ? chain_.dividend_yield + next_ : nullptr, size };
+
+			next_ += size;
+			return size;
+		}
+	};
+
+	// @ResultWriter : Formats the results of a chunk into one buffer and writes it with a single call
+	class ResultWriter
+	{
+	private:
+		std::ofstream output_{};
+		std::vector<char> buffer_{};	// Text of a chunk (CSV)
+		std::vector<double> rows_{};	// Interleaved results of a chunk (binary Greeks)
+		ChainOutputFormat format_{};
+		bool greeks_{};
+
+		static char* appendNumber(char* cursor, char* end, const double value) noexcept
+		{
+			return std::to_chars(cursor, end, value).ptr;
+		}
+
+	public:
+		ResultWriter(const std::string& path, const ChainStreamConfig& config)
+			: output_(path, std::ios::binary | std::ios::trunc), format_(config.output_format), greeks_(config.greeks)
+		{
+			if (!output_) throw std::runtime_error("[!] Can't open " + path + " for writing");
+
+			if (format_ == ChainOutputFormat::Binary && greeks_) rows_.resize(config.chunk_size * 6);
+			if (format_ == ChainOutputFormat::Csv)
+			{
+				buffer_.resize(config.chunk_size * (greeks_ ? 6 : 1) * 25);	// At most 24 characters per double plus its separator
+				output_ << (greeks_ ? "price,delta,gamma,theta,vega,rho\n" : "price\n");
+			}
+		}
+
+		void write(const ChainChunk& chunk)
+		{
+			if (format_ == ChainOutputFormat::Binary && !greeks_)
+			{
+				output_.write(reinterpret_cast<const char*>(chunk.price.data()), static_cast<std::streamsize>(chunk.size * sizeof(double)));
+			}
+			else if (format_ == ChainOutputFormat::Binary)
+			{
+				double* row = rows_.data();
+				for (std::size_t i{ 0 }; i < chunk.size; ++i, row += 6)
+				{
+					row[0] = chunk.price[i];
+					row[1] = chunk.delta[i];
+					row[2] = chunk.gamma[i];
+					row[3] = chunk.theta[i];
+					row[4] = chunk.vega[i];
+					row[5] = chunk.rho[i];
+				}
+				output_.write(reinterpret_cast<const char*>(rows_.data()), static_cast<std::streamsize>(chunk.size * 6 * sizeof(double)));
+			}
+			else
+			{
+				// Shortest round-trip representation of every double
+				char* cursor = buffer_.data();
+				char* const end = buffer_.data() + buffer_.size();
+				for (std::size_t i{ 0 }; i < chunk.size; ++i)
+				{
+					cursor = appendNumber(cursor, end, chunk.price[i]);
+					if (greeks_)
+					{
+						for (const auto* column : { &chunk.delta, &chunk.gamma, &chunk.theta, &chunk.vega, &chunk.rho })
+						{
+							*cursor++ = ',';
+							cursor = appendNumber(cursor, end, (*column)[i]);
+						}
+					}
+					*cursor++ = '\n';
+				}
+				output_.write(buffer_.data(), cursor - buffer_.data());
+			}
+
+			if (!output_) throw std::runtime_error("[!] Can't write the results");
+		}
+
+		void finish()
+		{
+			output_.flush();
+			if (!output_) throw std::runtime_error("[!] Can't write the results");
+		}
+	};
+}
+
+ChainStreamPricer::ChainStreamPricer(const ChainStreamConfig& config)
+	: config_(config)
+{
+	if (config_.chunk_size == 0) throw std::invalid_argument("[!] The chunk size must be positive");
+	if (config_.queue_depth == 0) throw std::invalid_argument("[!] At least one chunk must be in flight");
+}
+
+/*
+	@price: Parse, price and write stages over a ring of queue_depth chunks
+	-.The parser runs on its own thread and takes free chunks, the calling thread prices them, a writer thread writes them
+	and hands them back to the parser
+	-.The first exception of any stage aborts the three of them and is rethrown here once every thread has stopped
+*/
+ChainStreamStats ChainStreamPricer::price(const std::string& input_path, const std::string& output_path) const
+{
+	MappedFile file(input_path);
+	const bool records = isRecordsFile(file.data(), file.size());
+	const bool columns = isChainColumnsFile(file.data(), file.size());
+	ResultWriter writer(output_path, config_);
+
+	std::vector<ChainChunk> ring;
+	ring.reserve(config_.queue_depth);
+	ChunkQueue free_chunks, parsed_chunks, priced_chunks;
+	for (std::size_t i{ 0 }; i < config_.queue_depth; ++i)
+	{
+		ring.emplace_back(config_.chunk_size, config_.greeks);
+		free_chunks.push(&ring.back());
+	}
+
+	std::mutex error_mutex;
+	std::exception_ptr error;
+	const auto fail = [&](std::exception_ptr exception)
+	{
+		{
+			const std::lock_guard<std::mutex> lock(error_mutex);
+			if (!error) error = exception;
+		}
+		free_chunks.close(true);
+		parsed_chunks.close(true);
+		priced_chunks.close(true);
+	};
+
+	const auto parse = [&](auto& reader)
+	{
+		while (!reader.done())
+		{
+			ChainChunk* chunk = free_chunks.pop();
+			if (chunk == nullptr) break;
+
+			chunk->size = reader.read(*chunk, config_.chunk_size);
+			if (chunk->size == 0) break;	// Only blank lines were left
+			parsed_chunks.push(chunk);
+		}
+	};
+
+	std::thread parser([&]
+	{
+		try
+		{
+			if (records)
+			{
+				RecordChunkReader reader(file);
+				parse(reader);
+			}
+			else if (columns)
+			{
+				ColumnChunkReader reader(file);
+				parse(reader);
+			}
+			else
+			{
+				CsvChunkReader reader(file);
+				parse(reader);
+			}
+			parsed_chunks.close();
+		}
+		catch (...)
+		{
+			fail(std::current_exception());
+		}
+	});
+
+	ChainStreamStats stats;
+	std::thread output([&]
+	{
+		try
+		{
+			while (ChainChunk* chunk = priced_chunks.pop())
+			{
+				writer.write(*chunk);
+				stats.records += chunk->size;
+				stats.chunks += 1;
+				free_chunks.push(chunk);
+			}
+			writer.finish();
+		}
+		catch (...)
+		{
+			fail(std::current_exception());
+		}
+	});
+
+	try
+	{
+		const FinancialCalculator financial_calculator;
+		while (ChainChunk* chunk = parsed_chunks.pop())
+		{
+			if (config_.greeks)
+			{
+				financial_calculator.calculateGreeks(chunk->view(), chunk->greeks());
+			}
+			else
+			{
+				financial_calculator.calculateBlackScholes(chunk->view(), chunk->price.data());
+			}
+			priced_chunks.push(chunk);
+		}
+		priced_chunks.close();
+	}
+	catch (...)
+	{
+		fail(std::current_exception());
+	}
+
+	parser.join();
+	output.join();
+	if (error) std::rethrow_exception(error);
+
+	return stats;
+}
+
+[[nodiscard]] ChainFileFormat detectChainFileFormat(const std::string& path)
+{
+	std::ifstream input(path, std::ios::binary);
+	if (!input) throw std::runtime_error("[!] Can't open " + path);
+
+	char magic[sizeof(CHAIN_RECORDS_MAGIC)]{};
+	input.read(magic, sizeof(magic));
+	const std::size_t size = static_cast<std::size_t>(input.gcount());
+	if (isRecordsFile(magic, size)) return ChainFileFormat::BinaryRecords;
+	return isChainColumnsFile(magic, size) ? ChainFileFormat::Columns : ChainFileFormat::Csv;
+}
+
+void writeChainRecords(const std::string& path, const OptionChain& chain)
+{
+	std::ofstream output(path, std::ios::binary | std::ios::trunc);
+	if (!output) throw std::runtime_error("[!] Can't open " + path + " for writing");
+
+	ChainRecordsHeader header;
+	std::memcpy(header.magic, CHAIN_RECORDS_MAGIC, sizeof(header.magic));
+	header.version = CHAIN_RECORDS_VERSION;
+	header.record_size = sizeof(PackedOptionRecord);
+	header.records = chain.size;
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (std::size_t i{ 0 }; i < chain.size; ++i)
+	{
+		PackedOptionRecord row;
+		row.underlying_price = chain.underlying_price[i];
+		row.strike_price = chain.strike_price[i];
+		row.time = chain.time[i];
+		row.volatility = chain.volatility[i];
+		row.interest_rate = chain.interest_rate[i];
+		row.dividend_yield = chain.dividend_yield != nullptr ? chain.dividend_yield[i] : 0.0;
+		row.option_type = chain.option_type[i] == OptionType::Call ? 0 : 1;
+		output.write(reinterpret_cast<const char*>(&row), sizeof(row));
+	}
+
+	if (!output) throw std::runtime_error("[!] Can't write " + path);
+}
@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include "options.h"
+
+#include <cstdint>
+#include <string>
+
+/*
+*	Streaming chain pricer: option records are read from a file a chunk at a time, priced by the batch kernels and written out
+*	incrementally, so the memory used stays flat however large the input is
+*
+*	-.Three stages run concurrently on a fixed ring of chunks (parse -> price -> write), a chunk is only reused once its results
+*	have been written, so at most queue_depth chunks are alive at any time
+*	-.The input file is memory mapped, the pages already parsed are released as the parser moves forward
+*	-.Input formats (detected from the first bytes of the file):
+*		-. CSV : underlying_price,strike_price,time,volatility,interest_rate,option_type[,dividend_yield] per line, the option type
+*		is Call / Put (or C / P), an optional header line and blank lines are skipped
+*		-. Binary records : CHAIN_RECORDS_MAGIC, then 56 byte PackedOptionRecord rows (native endianness)
+*		-. Columns : the columnar format of chain_columns.h, its chunks are priced in place in the mapping without any copy
+*	-.Output formats: CSV lines (price, or price,delta,gamma,theta,vega,rho in Greeks mode) or raw native doubles with the same layout,
+*	one line / row per input record in input order
+*	-.Black-Scholes mode ignores dividends like calculateBlackScholes(chain), Greeks mode prices them like calculateGreeks(chain)
+*/
+
+enum class ChainFileFormat
+{
+	Csv,
+	BinaryRecords,
+	Columns,	// Columnar chain file of chain_columns.h
+};
+
+enum class ChainOutputFormat
+{
+	Csv,
+	Binary,
+};
+
+// Row of the binary records format
+struct PackedOptionRecord
+{
+	Price underlying_price{};
+	Price strike_price{};
+	Time time{};
+	Volatility volatility{};
+	InterestRate interest_rate{};
+	DividendYield dividend_yield{};
+	std::uint8_t option_type{};	// 0 Call, 1 Put
+	std::uint8_t padding[7]{};
+};
+
+static_assert(sizeof(PackedOptionRecord) == 56, "[!] PackedOptionRecord must stay 56 bytes, it is an on-disk layout");
+
+// Header of the binary records format
+struct ChainRecordsHeader
+{
+	char magic[8]{};
+	std::uint32_t version{};
+	std::uint32_t record_size{};
+	std::uint64_t records{};
+};
+
+constexpr char CHAIN_RECORDS_MAGIC[8] = { 'F', 'C', 'R', 'E', 'C', 'O', 'R', 'D' };
+constexpr std::uint32_t CHAIN_RECORDS_VERSION = 1;
+
+struct ChainStreamConfig
+{
+	std::size_t chunk_size{ 1 << 16 };	// Records priced per batch call
+	std::size_t queue_depth{ 4 };		// Chunks in flight across the three stages (at least 3 keeps every stage busy)
+	bool greeks{ false };			// Price and every greek instead of the Black-Scholes price only
+	ChainOutputFormat output_format{ ChainOutputFormat::Csv };
+};
+
+struct ChainStreamStats
+{
+	std::uint64_t records{};
+	std::uint64_t chunks{};
+};
+
+class ChainStreamPricer
+{
+public:
+	explicit ChainStreamPricer(const ChainStreamConfig& config = {});
+
+	// @price : Prices every record of input_path into output_path, throws on malformed input (the output is then incomplete)
+	ChainStreamStats price(const std::string& input_path, const std::string& output_path) const;
+
+private:
+	ChainStreamConfig config_{};
+};
+
+// @detectChainFileFormat : Binary records / columns when the file starts with their magic, CSV otherwise
+[[nodiscard]] ChainFileFormat detectChainFileFormat(const std::string& path);
+
+// @writeChainRecords : Writes a chain in the binary records format (every column of the chain must be set, dividend_yield included or nullptr)
+void writeChainRecords(const std::string& path, const OptionChain& chain);
@@ -0,0 +1,104 @@
+﻿#include "compact_book.h"
+#include "metrics.h"
+#include "simd.h"
+
+CompactOptionBook::CompactOptionBook(std::pmr::memory_resource* resource)
+	: underlying_price_(resource), strike_price_(resource), time_(resource), volatility_(resource), interest_rate_(resource), dividend_yield_(resource),
+	put_bits_(resource)
+{
+}
+
+CompactOptionBook::CompactOptionBook(const OptionChain& chain, std::pmr::memory_resource* resource) : CompactOptionBook(resource)
+{
+	reserve(chain.size);
+	for (std::size_t i{ 0 }; i < chain.size; ++i)
+	{
+		const DividendYield dividend_yield = chain.dividend_yield != nullptr ? chain.dividend_yield[i] : 0.0;
+		add(GreeksParams{ chain.interest_rate[i], chain.underlying_price[i], chain.strike_price[i], chain.time[i], chain.volatility[i], chain.option_type[i], 0.0, dividend_yield });
+	}
+}
+
+void CompactOptionBook::reserve(const std::size_t contracts)
+{
+	underlying_price_.reserve(contracts);
+	strike_price_.reserve(contracts);
+	time_.reserve(contracts);
+	volatility_.reserve(contracts);
+	interest_rate_.reserve(contracts);
+	dividend_yield_.reserve(contracts);
+	put_bits_.reserve((contracts + 63) / 64);
+}
+
+void CompactOptionBook::add(const BlackScholesParams& params)
+{
+	add(GreeksParams{ params.interest_rate, params.underlying_price, params.strike_price, params.time, params.volatility, params.option_type, 0.0, 0.0 });
+}
+
+void CompactOptionBook::add(const GreeksParams& params)
+{
+	if (params.option_type != OptionType::Call && params.option_type != OptionType::Put)
+	{
+		throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+	}
+
+	const std::size_t i = size();
+	if (i % 64 == 0) put_bits_.push_back(0);
+	put_bits_.back() |= static_cast<std::uint64_t>(params.option_type == OptionType::Put) << (i % 64);
+
+	underlying_price_.push_back(params.underlying_price);
+	strike_price_.push_back(params.strike_price);
+	time_.push_back(static_cast<float>(params.time));
+	volatility_.push_back(static_cast<float>(params.volatility));
+	interest_rate_.push_back(static_cast<float>(params.interest_rate));
+	dividend_yield_.push_back(static_cast<float>(params.dividend_yield));
+}
+
+[[nodiscard]] std::size_t CompactOptionBook::memoryBytes() const noexcept
+{
+	return (underlying_price_.capacity() + strike_price_.capacity()) * sizeof(Price)
+		+ (time_.capacity() + volatility_.capacity() + interest_rate_.capacity() + dividend_yield_.capacity()) * sizeof(float)
+		+ put_bits_.capacity() * sizeof(std::uint64_t);
+}
+
+[[nodiscard]] BlackScholesParams CompactOptionBook::blackScholesParams(const std::size_t i) const noexcept
+{
+	return BlackScholesParams{ interest_rate_[i], underlying_price_[i], strike_price_[i], time_[i], volatility_[i], optionType(i), 0.0 };
+}
+
+[[nodiscard]] GreeksParams CompactOptionBook::greeksParams(const std::size_t i) const noexcept
+{
+	return GreeksParams{ interest_rate_[i], underlying_price_[i], strike_price_[i], time_[i], volatility_[i], optionType(i), 0.0, dividend_yield_[i] };
+}
+
+void CompactOptionBook::setUnderlyingPrice(const Price spot) noexcept
+{
+	std::fill(underlying_price_.begin(), underlying_price_.end(), spot);
+}
+
+[[nodiscard]] CompactOptionChain CompactOptionBook::view() const noexcept
+{
+	return CompactOptionChain{ underlying_price_.data(), strike_price_.data(), time_.data(), volatility_.data(), interest_rate_.data(), dividend_yield_.data(),
+		put_bits_.data(), size() };
+}
+
+void CompactOptionBook::calculateBlackScholes(Price* prices) const noexcept
+{
+	FC_METRICS_SCOPE(BlackScholesChain);
+	FC_METRICS_ITEMS(size());
+
+	calculateBlackScholesBatch(view(), prices);
+}
+
+void CompactOptionBook::calculateGreeks(const OptionGreeksChain& greeks) const
+{
+	FC_METRICS_SCOPE(GreeksChain);
+	FC_METRICS_ITEMS(size());
+
+	for (std::size_t i{ 0 }; i < size(); ++i)
+	{
+		if (time_[i] <= 0) throw std::runtime_error("[!] Time must be positive");
+		if (volatility_[i] <= 0) throw std::runtime_error("[!] Volatility must be positive");
+	}
+
+	calculateGreeksBatch(view(), greeks);
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include "options.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+/*
+*	Compact resident book of contracts for large batch repricing: the chain columns kept in their smallest faithful storage so a book
+*	of millions of contracts stays in the last level caches
+*
+*	-.Prices stay doubles, the time, volatility, interest rate and dividend yield columns are stored as float32 (about 7 significant
+*	digits, far below the precision of the market inputs) and the option types as one bit per contract (set for a Put)
+*	-.A contract costs 32 bytes and a bit, against 49 bytes in the OptionChain columns and 56 / 64 bytes as a BlackScholesParams /
+*	GreeksParams (the padding of their OptionType and their paid_price)
+*	-.The batch pricers run the chain kernels of simd.h directly on the book (CompactOptionChain), the float32 columns are widened inside
+*	the vector loads and the signs read from the type bits, a contract priced from the book gets the price of its float-rounded inputs
+*	-.The book never goes through the GPU backend of the calculator, it is priced on the CPU kernels only
+*	-.No per-contract copy is made, so the book prices at least as fast as the OptionChain columns (BM_BookBlackScholes) on a quarter less memory
+*	-.blackScholesParams / greeksParams convert a contract back to the existing param structs (paid_price is left at 0)
+*	-.Every column is allocated from the memory resource given at construction
+*/
+
+// @CompactOptionChain : Non-owning view of the columns of a CompactOptionBook, every column points to `size` contiguous elements
+struct CompactOptionChain
+{
+	const Price* underlying_price{};
+	const Price* strike_price{};
+	const float* time{};
+	const float* volatility{};
+	const float* interest_rate{};
+	const float* dividend_yield{};	// Only read by the Greeks pricers (nullptr means no dividends)
+	const std::uint64_t* put_bits{};	// Bit i % 64 of word i / 64 is set when contract i is a Put
+	std::size_t size{};
+};
+
+class CompactOptionBook
+{
+private:
+	std::pmr::vector<Price> underlying_price_;
+	std::pmr::vector<Price> strike_price_;
+	std::pmr::vector<float> time_;
+	std::pmr::vector<float> volatility_;
+	std::pmr::vector<float> interest_rate_;
+	std::pmr::vector<float> dividend_yield_;
+	std::pmr::vector<std::uint64_t> put_bits_;	// Bit i % 64 of word i / 64 is set when contract i is a Put
+
+public:
+	explicit CompactOptionBook(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	// Copies a chain (a missing dividend_yield column stores 0), throws on an option type other than Call / Put
+	explicit CompactOptionBook(const OptionChain& chain, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	void reserve(std::size_t contracts);
+
+	// @add : Appends one contract (paid_price is not stored), throws on an option type other than Call / Put
+	void add(const BlackScholesParams& params);
+	void add(const GreeksParams& params);
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return underlying_price_.size(); }
+
+	// @memoryBytes : Bytes held by the columns of the book (capacity, not size)
+	[[nodiscard]] std::size_t memoryBytes() const noexcept;
+
+	[[nodiscard]] inline OptionType optionType(const std::size_t i) const noexcept
+	{
+		return ((put_bits_[i / 64] >> (i % 64)) & 1) != 0 ? OptionType::Put : OptionType::Call;
+	}
+
+	[[nodiscard]] BlackScholesParams blackScholesParams(std::size_t i) const noexcept;
+	[[nodiscard]] GreeksParams greeksParams(std::size_t i) const noexcept;
+
+	[[nodiscard]] CompactOptionChain view() const noexcept;
+
+	// @setUnderlyingPrice : Moves the spot of every contract of the book (single underlying books repriced per tick)
+	void setUnderlyingPrice(Price spot) noexcept;
+
+	// @calculateBlackScholes : prices[i] = FinancialCalculator::calculateBlackScholes(chain) of contract i (dividends ignored), the types of
+	// the book are always valid so it never throws
+	void calculateBlackScholes(Price* prices) const noexcept;
+
+	// @calculateGreeks : Price and every greek of each contract (dividends included), like FinancialCalculator::calculateGreeks(chain),
+	// throws like it on a non-positive time or volatility before pricing anything
+	void calculateGreeks(const OptionGreeksChain& greeks) const;
+};
@@ -0,0 +1,31 @@
+﻿#include "gpu_backend.h"
+
+// Host-only build: the CUDA backend lives in gpu_backend.cu, these keep the calculator on its CPU kernels
+#if !defined(FC_CUDA)
+
+[[nodiscard]] bool gpuAvailable() noexcept
+{
+	return false;
+}
+
+[[nodiscard]] bool gpuSupportsMonteCarlo(const MonteCarloParams& /*params*/) noexcept
+{
+	return false;
+}
+
+[[nodiscard]] bool gpuSimulatePayoffs(const MonteCarloParams& /*params*/, std::size_t /*number_of_samples*/, std::uint64_t /*seed*/, PayoffStatistics& /*statistics*/) noexcept
+{
+	return false;
+}
+
+[[nodiscard]] bool gpuBlackScholesBatch(const OptionChain& /*chain*/, Price* /*prices*/) noexcept
+{
+	return false;
+}
+
+[[nodiscard]] bool gpuGreeksBatch(const OptionChain& /*chain*/, const OptionGreeksChain& /*greeks*/) noexcept
+{
+	return false;
+}
+
+#endif
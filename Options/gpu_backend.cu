@@ -0,0 +1,474 @@
+﻿#include "gpu_backend.h"
+
+#include <cuda_runtime.h>
+#include <curand_kernel.h>
+
+#include <algorithm>
+
+namespace
+{
+	constexpr unsigned int THREADS_PER_BLOCK = 256;	// Power of two (tree reductions)
+	constexpr unsigned int MAX_BLOCKS = 1024;		// Grid-stride loops beyond that
+	constexpr int STATISTICS = 5;			// Σ Y, Σ Y², Σ X, Σ X², Σ X·Y of PayoffStatistics
+
+	// Running statistic of a path, the device twin of the CPU engine's PathStatistic
+	enum class DeviceStatistic : int
+	{
+		None,
+		Sum,
+		Maximum,
+		Minimum,
+		CrossedAbove,
+		CrossedBelow,
+	};
+
+	// Everything the path kernel reads, passed by value in the kernel parameters
+	struct DevicePaths
+	{
+		double spot;
+		double strike;
+		double barrier;
+		double drift;			// (r - σ²/2)Δt
+		double diffusion_scale;		// σ√Δt
+		unsigned long long samples;
+		unsigned long long steps;
+		unsigned long long seed;
+		PathPayoff path_payoff;
+		DeviceStatistic statistic;
+		bool call;
+		bool antithetic;
+		bool control_variate;
+		bool spot_control;	// Control variate: S_T (European payoffs) rather than the European payoff
+		bool knock_out;
+	};
+
+	// Columns of a chain copied to the device (dividend_yield is nullptr when the chain has none)
+	struct DeviceChain
+	{
+		const double* underlying_price;
+		const double* strike_price;
+		const double* time;
+		const double* volatility;
+		const double* interest_rate;
+		const double* dividend_yield;
+		const OptionType* option_type;
+		unsigned long long size;
+	};
+
+	[[nodiscard]] DeviceStatistic deviceStatistic(const PathPayoff path_payoff, const bool call) noexcept
+	{
+		switch (path_payoff)
+		{
+		case PathPayoff::Asian: return DeviceStatistic::Sum;
+		case PathPayoff::UpAndOut:
+		case PathPayoff::UpAndIn: return DeviceStatistic::CrossedAbove;
+		case PathPayoff::DownAndOut:
+		case PathPayoff::DownAndIn: return DeviceStatistic::CrossedBelow;
+		case PathPayoff::LookbackFixedStrike: return call ? DeviceStatistic::Maximum : DeviceStatistic::Minimum;
+		case PathPayoff::LookbackFloatingStrike: return call ? DeviceStatistic::Minimum : DeviceStatistic::Maximum;
+		default: return DeviceStatistic::None;
+		}
+	}
+
+	__device__ inline double intrinsic(const bool call, const double underlying_price, const double strike_price)
+	{
+		return call ? fmax(underlying_price - strike_price, 0.0) : fmax(strike_price - underlying_price, 0.0);
+	}
+
+	__device__ inline double initialStatistic(const DevicePaths& paths)
+	{
+		switch (paths.statistic)
+		{
+		case DeviceStatistic::Maximum:
+		case DeviceStatistic::Minimum: return paths.spot;
+		case DeviceStatistic::CrossedAbove: return paths.spot >= paths.barrier ? 1.0 : 0.0;
+		case DeviceStatistic::CrossedBelow: return paths.spot <= paths.barrier ? 1.0 : 0.0;
+		default: return 0.0;
+		}
+	}
+
+	__device__ inline double updateStatistic(const DevicePaths& paths, const double statistic, const double price)
+	{
+		switch (paths.statistic)
+		{
+		case DeviceStatistic::Sum: return statistic + price;
+		case DeviceStatistic::Maximum: return fmax(statistic, price);
+		case DeviceStatistic::Minimum: return fmin(statistic, price);
+		case DeviceStatistic::CrossedAbove: return price >= paths.barrier ? 1.0 : statistic;
+		case DeviceStatistic::CrossedBelow: return price <= paths.barrier ? 1.0 : statistic;
+		default: return statistic;
+		}
+	}
+
+	__device__ inline double pathPayoff(const DevicePaths& paths, const double price, const double statistic)
+	{
+		switch (paths.path_payoff)
+		{
+		case PathPayoff::Asian: return intrinsic(paths.call, statistic / static_cast<double>(paths.steps), paths.strike);
+		case PathPayoff::UpAndOut:
+		case PathPayoff::DownAndOut: return statistic != 0.0 ? 0.0 : intrinsic(paths.call, price, paths.strike);
+		case PathPayoff::UpAndIn:
+		case PathPayoff::DownAndIn: return statistic != 0.0 ? intrinsic(paths.call, price, paths.strike) : 0.0;
+		case PathPayoff::LookbackFixedStrike: return intrinsic(paths.call, statistic, paths.strike);
+		case PathPayoff::LookbackFloatingStrike: return intrinsic(paths.call, price, statistic);	// The extreme is the strike
+		default: return intrinsic(paths.call, price, paths.strike);
+		}
+	}
+
+	// @blockSum : Sum of value over the threads of the block, shared holds THREADS_PER_BLOCK doubles (every thread gets the sum)
+	__device__ double blockSum(const double value, double* shared)
+	{
+		shared[threadIdx.x] = value;
+		__syncthreads();
+		for (unsigned int half{ blockDim.x / 2 }; half > 0; half /= 2)
+		{
+			if (threadIdx.x < half) shared[threadIdx.x] += shared[threadIdx.x + half];
+			__syncthreads();
+		}
+		const double sum = shared[0];
+		__syncthreads();	// shared is reused by the next reduction
+		return sum;
+	}
+
+	/*
+		@simulatePayoffsKernel: One thread per sample (grid-stride), same paths and payoffs as FinancialCalculator::simulatePayoffs
+		-.Sample i draws its normals from Philox subsequence i of the seed, whatever thread or launch simulates it
+		-.A knocked-out path (pair) pays 0 whatever happens next, it stops there (not with a control variate, which needs S_T)
+		-.partials[k * gridDim.x + block] receives statistic k of the samples of the block
+	*/
+	__global__ void simulatePayoffsKernel(const DevicePaths paths, double* partials)
+	{
+		__shared__ double shared[THREADS_PER_BLOCK];
+		double sums[STATISTICS] = {};
+
+		const unsigned long long stride = static_cast<unsigned long long>(gridDim.x) * blockDim.x;
+		for (unsigned long long sample{ static_cast<unsigned long long>(blockIdx.x) * blockDim.x + threadIdx.x }; sample < paths.samples; sample += stride)
+		{
+			curandStatePhilox4_32_10_t state;
+			curand_init(paths.seed, sample, 0, &state);
+
+			const double initial_statistic = initialStatistic(paths);
+			double price{ paths.spot };
+			double mirrored_price{ paths.spot };
+			double statistic{ initial_statistic };
+			double mirrored_statistic{ initial_statistic };
+
+			bool live = !(paths.knock_out && initial_statistic != 0.0);
+			for (unsigned long long step{ 0 }; step < paths.steps && live; ++step)
+			{
+				// Geometric Brownian Motion, the mirrored path uses -Z
+				const double normal = curand_normal_double(&state);
+				price *= exp(paths.drift + paths.diffusion_scale * normal);
+				statistic = updateStatistic(paths, statistic, price);
+				if (paths.antithetic)
+				{
+					mirrored_price *= exp(paths.drift - paths.diffusion_scale * normal);
+					mirrored_statistic = updateStatistic(paths, mirrored_statistic, mirrored_price);
+				}
+
+				if (paths.knock_out) live = statistic == 0.0 || (paths.antithetic && mirrored_statistic == 0.0);
+			}
+
+			const double payoff = paths.antithetic ? 0.5 * (pathPayoff(paths, price, statistic) + pathPayoff(paths, mirrored_price, mirrored_statistic)) :
+				pathPayoff(paths, price, statistic);
+			sums[0] += payoff;
+			sums[1] += payoff * payoff;
+
+			if (paths.control_variate)
+			{
+				const double control_payoff = paths.spot_control ? price : intrinsic(paths.call, price, paths.strike);
+				sums[2] += control_payoff;
+				sums[3] += control_payoff * control_payoff;
+				sums[4] += control_payoff * payoff;
+			}
+		}
+
+		for (int k{ 0 }; k < STATISTICS; ++k)
+		{
+			const double sum = blockSum(sums[k], shared);
+			if (threadIdx.x == 0) partials[k * gridDim.x + blockIdx.x] = sum;
+		}
+	}
+
+	// @reducePartialsKernel : One block folds the partials of every block in a fixed order, so a seed always gives the same sums
+	__global__ void reducePartialsKernel(const double* partials, const unsigned int blocks, double* totals)
+	{
+		__shared__ double shared[THREADS_PER_BLOCK];
+
+		for (int k{ 0 }; k < STATISTICS; ++k)
+		{
+			double sum{ 0.0 };
+			for (unsigned int block{ threadIdx.x }; block < blocks; block += blockDim.x)
+			{
+				sum += partials[k * blocks + block];
+			}
+			sum = blockSum(sum, shared);
+			if (threadIdx.x == 0) totals[k] = sum;
+		}
+	}
+
+	__device__ inline double normalCdfDevice(const double x)
+	{
+		return 0.5 * erfc(-x * 0.70710678118654752440);	// N(x) = erfc(-x / √2) / 2
+	}
+
+	__device__ inline double normalPdfDevice(const double x)
+	{
+		return 0.39894228040143267794 * exp(-0.5 * x * x);
+	}
+
+	// Sign trick of the CPU kernels : price = sign * (S * N(sign * d1) - K * e^(-rT) * N(sign * d2))
+	__global__ void blackScholesKernel(const DeviceChain chain, double* prices)
+	{
+		const unsigned long long stride = static_cast<unsigned long long>(gridDim.x) * blockDim.x;
+		for (unsigned long long i{ static_cast<unsigned long long>(blockIdx.x) * blockDim.x + threadIdx.x }; i < chain.size; i += stride)
+		{
+			const double sign = chain.option_type[i] == OptionType::Call ? 1.0 : -1.0;
+			const double volatility = chain.volatility[i];
+			const double time = chain.time[i];
+			const double volatility_sqrt_time = volatility * sqrt(time);
+
+			const double d1 = (log(chain.underlying_price[i] / chain.strike_price[i]) + (chain.interest_rate[i] + volatility * volatility * 0.5) * time) / volatility_sqrt_time;
+			const double d2 = d1 - volatility_sqrt_time;
+			const double discount = exp(-chain.interest_rate[i] * time);
+
+			prices[i] = sign * (chain.underlying_price[i] * normalCdfDevice(sign * d1) - chain.strike_price[i] * discount * normalCdfDevice(sign * d2));
+		}
+	}
+
+	// Same formulas as greeksLanes of simd.cpp, greeks holds the price / delta / gamma / theta / vega / rho columns back to back
+	__global__ void greeksKernel(const DeviceChain chain, double* greeks)
+	{
+		const unsigned long long stride = static_cast<unsigned long long>(gridDim.x) * blockDim.x;
+		for (unsigned long long i{ static_cast<unsigned long long>(blockIdx.x) * blockDim.x + threadIdx.x }; i < chain.size; i += stride)
+		{
+			const double sign = chain.option_type[i] == OptionType::Call ? 1.0 : -1.0;
+			const double underlying_price = chain.underlying_price[i];
+			const double time = chain.time[i];
+			const double volatility = chain.volatility[i];
+			const double interest_rate = chain.interest_rate[i];
+			const double dividend_yield = chain.dividend_yield != nullptr ? chain.dividend_yield[i] : 0.0;
+			const double sqrt_time = sqrt(time);
+			const double volatility_sqrt_time = volatility * sqrt_time;
+
+			const double d1 = (log(underlying_price / chain.strike_price[i]) + (interest_rate + volatility * volatility * 0.5) * time) / volatility_sqrt_time;
+			const double d2 = d1 - volatility_sqrt_time;
+
+			const double discount = exp(-interest_rate * time);
+			const double dividend_discount = exp(-dividend_yield * time);
+			const double cdf_d1 = normalCdfDevice(sign * d1);
+			const double cdf_d2 = normalCdfDevice(sign * d2);
+			const double pdf_d1 = normalPdfDevice(d1);
+
+			const double spot_term = underlying_price * dividend_discount;
+			const double strike_term = chain.strike_price[i] * discount;
+
+			greeks[i] = sign * (spot_term * cdf_d1 - strike_term * cdf_d2);
+			greeks[chain.size + i] = sign * dividend_discount * cdf_d1;
+			greeks[2 * chain.size + i] = (dividend_discount * pdf_d1) / (underlying_price * volatility_sqrt_time);
+			greeks[3 * chain.size + i] = -(spot_term * volatility * pdf_d1) / (2.0 * sqrt_time) - sign * (interest_rate * strike_term * cdf_d2 - dividend_yield * spot_term * cdf_d1);
+			greeks[4 * chain.size + i] = spot_term * pdf_d1 * sqrt_time;
+			greeks[5 * chain.size + i] = sign * strike_term * time * cdf_d2;
+		}
+	}
+
+	// Device allocation of one host thread, only grown (never shrunk) so the steady state of repeated calls allocates nothing
+	class DeviceBuffer
+	{
+	private:
+		void* data_{};
+		std::size_t capacity_{};
+
+	public:
+		DeviceBuffer() = default;
+		~DeviceBuffer()
+		{
+			if (data_ != nullptr) cudaFree(data_);
+		}
+
+		DeviceBuffer(const DeviceBuffer&) = delete;
+		DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+
+		// @reserve : At least bytes of device memory, nullptr when the allocation failed
+		[[nodiscard]] void* reserve(const std::size_t bytes) noexcept
+		{
+			if (bytes <= capacity_) return data_;
+
+			if (data_ != nullptr) cudaFree(data_);
+			data_ = nullptr;
+			capacity_ = 0;
+			if (cudaMalloc(&data_, bytes) != cudaSuccess)
+			{
+				cudaGetLastError();
+				data_ = nullptr;
+				return nullptr;
+			}
+			capacity_ = bytes;
+			return data_;
+		}
+	};
+
+	[[nodiscard]] DeviceBuffer& pathBuffer() noexcept
+	{
+		thread_local DeviceBuffer buffer;
+		return buffer;
+	}
+
+	[[nodiscard]] DeviceBuffer& chainBuffer() noexcept
+	{
+		thread_local DeviceBuffer buffer;
+		return buffer;
+	}
+
+	[[nodiscard]] unsigned int blocksFor(const std::size_t items) noexcept
+	{
+		const std::size_t blocks = (items + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+		return static_cast<unsigned int>(std::clamp<std::size_t>(blocks, 1, MAX_BLOCKS));
+	}
+
+	// @finish : Waits for the work queued on the stream, false (and the error cleared) if it or any call before it failed
+	[[nodiscard]] bool finish(cudaError_t status) noexcept
+	{
+		if (status == cudaSuccess) status = cudaGetLastError();
+		if (status == cudaSuccess) status = cudaStreamSynchronize(cudaStreamPerThread);
+		if (status != cudaSuccess) cudaGetLastError();
+		return status == cudaSuccess;
+	}
+
+	/*
+		@uploadChain: Copies the columns of the chain into the chain buffer of the thread, followed by output_columns output columns
+		-.Layout: the 5 (6 with dividends) input columns, the output columns, then the option types (bytes)
+		-.Returns the device view of the chain and sets outputs, or reports false when the buffer couldn't be allocated / filled
+	*/
+	[[nodiscard]] bool uploadChain(const OptionChain& chain, const std::size_t output_columns, DeviceChain& device_chain, double*& outputs, cudaError_t& status) noexcept
+	{
+		const std::size_t size = chain.size;
+		const std::size_t input_columns = chain.dividend_yield != nullptr ? 6 : 5;
+		auto* columns = static_cast<double*>(chainBuffer().reserve((input_columns + output_columns) * size * sizeof(double) + size * sizeof(OptionType)));
+		if (columns == nullptr) return false;
+
+		const double* host_columns[] = { chain.underlying_price, chain.strike_price, chain.time, chain.volatility, chain.interest_rate, chain.dividend_yield };
+		for (std::size_t column{ 0 }; column < input_columns && status == cudaSuccess; ++column)
+		{
+			status = cudaMemcpyAsync(columns + column * size, host_columns[column], size * sizeof(double), cudaMemcpyHostToDevice, cudaStreamPerThread);
+		}
+
+		auto* option_type = reinterpret_cast<OptionType*>(columns + (input_columns + output_columns) * size);
+		if (status == cudaSuccess) status = cudaMemcpyAsync(option_type, chain.option_type, size * sizeof(OptionType), cudaMemcpyHostToDevice, cudaStreamPerThread);
+
+		device_chain = { columns, columns + size, columns + 2 * size, columns + 3 * size, columns + 4 * size, input_columns == 6 ? columns + 5 * size : nullptr, option_type, size };
+		outputs = columns + input_columns * size;
+		return status == cudaSuccess;
+	}
+}
+
+[[nodiscard]] bool gpuAvailable() noexcept
+{
+	static const bool available = []
+	{
+		int devices{ 0 };
+		const bool found = cudaGetDeviceCount(&devices) == cudaSuccess && devices > 0;
+		if (!found) cudaGetLastError();
+		return found;
+	}();
+	return available;
+}
+
+[[nodiscard]] bool gpuSupportsMonteCarlo(const MonteCarloParams& params) noexcept
+{
+	return params.sampling_method == SamplingMethod::PseudoRandom && params.target_standard_error == 0 && params.time_budget == 0 && params.assets.empty();
+}
+
+[[nodiscard]] bool gpuSimulatePayoffs(const MonteCarloParams& params, const std::size_t number_of_samples, const std::uint64_t seed, PayoffStatistics& statistics) noexcept
+{
+	if (!gpuAvailable()) return false;
+
+	const bool call = params.option_type == OptionType::Call;
+	const bool control_variate = params.variance_reduction == VarianceReduction::ControlVariate;
+	const auto steps = static_cast<unsigned long long>(monteCarloSteps(params));
+	const double time_step = params.time / static_cast<double>(steps);
+
+	DevicePaths paths{};
+	paths.spot = params.underlying_price;
+	paths.strike = params.strike_price;
+	paths.barrier = params.barrier;
+	paths.drift = (params.interest_rate - 0.5 * params.volatility * params.volatility) * time_step;
+	paths.diffusion_scale = params.volatility * std::sqrt(time_step);
+	paths.samples = number_of_samples;
+	paths.steps = steps;
+	paths.seed = seed;
+	paths.path_payoff = params.path_payoff;
+	paths.statistic = deviceStatistic(params.path_payoff, call);
+	paths.call = call;
+	paths.antithetic = params.variance_reduction == VarianceReduction::Antithetic;
+	paths.control_variate = control_variate;
+	paths.spot_control = params.path_payoff == PathPayoff::European;
+	paths.knock_out = (params.path_payoff == PathPayoff::UpAndOut || params.path_payoff == PathPayoff::DownAndOut) && !control_variate;
+
+	const unsigned int blocks = blocksFor(number_of_samples);
+	auto* partials = static_cast<double*>(pathBuffer().reserve((blocks + 1) * STATISTICS * sizeof(double)));
+	if (partials == nullptr) return false;
+	double* totals = partials + blocks * STATISTICS;
+
+	simulatePayoffsKernel<<<blocks, THREADS_PER_BLOCK, 0, cudaStreamPerThread>>>(paths, partials);
+	reducePartialsKernel<<<1, THREADS_PER_BLOCK, 0, cudaStreamPerThread>>>(partials, blocks, totals);
+
+	double sums[STATISTICS]{};
+	cudaError_t status = cudaGetLastError();
+	if (status == cudaSuccess) status = cudaMemcpyAsync(sums, totals, sizeof(sums), cudaMemcpyDeviceToHost, cudaStreamPerThread);
+	if (!finish(status)) return false;
+
+	statistics = PayoffStatistics{};
+	statistics.sum = sums[0];
+	statistics.sum_squares = sums[1];
+	statistics.control_sum = sums[2];
+	statistics.control_sum_squares = sums[3];
+	statistics.cross_sum = sums[4];
+	statistics.samples = number_of_samples;
+	return true;
+}
+
+[[nodiscard]] bool gpuBlackScholesBatch(const OptionChain& chain, Price* prices) noexcept
+{
+	if (!gpuAvailable()) return false;
+	if (chain.size == 0) return true;
+
+	DeviceChain device_chain{};
+	double* device_prices{};
+	cudaError_t status = cudaSuccess;
+	if (!uploadChain(chain, 1, device_chain, device_prices, status))
+	{
+		static_cast<void>(finish(status));	// Drains the copies already queued and clears the error
+		return false;
+	}
+
+	blackScholesKernel<<<blocksFor(chain.size), THREADS_PER_BLOCK, 0, cudaStreamPerThread>>>(device_chain, device_prices);
+	status = cudaGetLastError();
+	if (status == cudaSuccess) status = cudaMemcpyAsync(prices, device_prices, chain.size * sizeof(Price), cudaMemcpyDeviceToHost, cudaStreamPerThread);
+	return finish(status);
+}
+
+[[nodiscard]] bool gpuGreeksBatch(const OptionChain& chain, const OptionGreeksChain& greeks) noexcept
+{
+	if (!gpuAvailable()) return false;
+	if (chain.size == 0) return true;
+
+	DeviceChain device_chain{};
+	double* device_greeks{};
+	cudaError_t status = cudaSuccess;
+	if (!uploadChain(chain, 6, device_chain, device_greeks, status))
+	{
+		static_cast<void>(finish(status));	// Drains the copies already queued and clears the error
+		return false;
+	}
+
+	greeksKernel<<<blocksFor(chain.size), THREADS_PER_BLOCK, 0, cudaStreamPerThread>>>(device_chain, device_greeks);
+	status = cudaGetLastError();
+
+	double* const columns[] = { greeks.price, greeks.delta, greeks.gamma, greeks.theta, greeks.vega, greeks.rho };
+	for (std::size_t column{ 0 }; column < 6 && status == cudaSuccess; ++column)
+	{
+		status = cudaMemcpyAsync(columns[column], device_greeks + column * chain.size, chain.size * sizeof(double), cudaMemcpyDeviceToHost, cudaStreamPerThread);
+	}
+	return finish(status);
+}
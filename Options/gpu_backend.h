@@ -0,0 +1,33 @@
+﻿#pragma once
+
+#include "options.h"
+
+/*
+*	Optional CUDA backend of FinancialCalculator, picked with setComputeBackend(ComputeBackend::Gpu) and compiled in with -DFC_CUDA
+*	and gpu_backend.cu (nvcc), without them every call below reports false and the calculator stays on the CPU kernels
+*
+*	-.Monte Carlo : one device thread per sample (a path, or an antithetic pair) with its own Philox subsequence (curand), the whole path
+*	and its running statistic stay in registers, every block reduces its payoff sums in shared memory and a second pass reduces the
+*	blocks: only the PayoffStatistics sums are copied back. The sample i always uses subsequence i of the seed, so the estimate only
+*	depends on the parameters (not on the launch shape), but it differs from the CPU engines' one
+*	-.Batch closed forms : the chain columns are copied to buffers kept resident on the device between calls (one set per host thread,
+*	grown on demand), one thread per contract, only the outputs come back
+*	-.Every entry point is noexcept: a missing device or a failed CUDA call returns false and the caller runs the CPU path instead
+*	-.Device work is issued on the per-thread default stream, the calculator can be used from several host threads at once
+*/
+
+// Smallest chain the closed form pricers send to the device, below it the copies cost more than the CPU kernels
+constexpr std::size_t GPU_MIN_CHAIN_SIZE = 1 << 14;
+
+// @gpuAvailable : True when the backend is compiled in and a CUDA device is present (probed once)
+[[nodiscard]] bool gpuAvailable() noexcept;
+
+// @gpuSupportsMonteCarlo : The device engine covers pseudo-random sampling of every payoff, variance reduction and simulation mode (not Sobol, progressive runs or baskets)
+[[nodiscard]] bool gpuSupportsMonteCarlo(const MonteCarloParams& params) noexcept;
+
+// @gpuSimulatePayoffs : Undiscounted statistics of number_of_samples samples of params (same semantics as the CPU workers), false on failure
+[[nodiscard]] bool gpuSimulatePayoffs(const MonteCarloParams& params, std::size_t number_of_samples, std::uint64_t seed, PayoffStatistics& statistics) noexcept;
+
+// @gpuBlackScholesBatch / @gpuGreeksBatch : Device versions of calculateBlackScholesBatch / calculateGreeksBatch (chain already validated), false on failure
+[[nodiscard]] bool gpuBlackScholesBatch(const OptionChain& chain, Price* prices) noexcept;
+[[nodiscard]] bool gpuGreeksBatch(const OptionChain& chain, const OptionGreeksChain& greeks) noexcept;
@@ -1,6 +1,9 @@
-﻿#include <iostream>
+﻿#include <cstring>
+#include <iostream>
+#include <string>
 
 #include "options.h"
+#include "chain_stream.h"
 
 BlackScholesParams bs_params
 {
@@ -25,11 +28,50 @@ MonteCarloParams mtc_params
 	0.0
 };
 
-int main(int agrc, char** argv)
+/*
+	Without arguments the sample parameters above are priced, otherwise a chain file is streamed through the batch pricers:
+		Options <input> <output> [--greeks] [--binary-output] [--chunk-size N] [--queue-depth N]
+	-.<input> is a CSV file, a binary records file (see chain_stream.h) or a columnar chain file (see chain_columns.h), the format is
+	detected from its first bytes
+*/
+int main(int argc, char** argv)
 {
 	FinancialCalculator financial_calculator;
-	std::cout << financial_calculator.calculateBlackScholes(bs_params) << std::endl;
-	std::cout << financial_calculator.calculateMonteCarlo(mtc_params) << std::endl;
+
+	if (argc == 1)
+	{
+		std::cout << financial_calculator.calculateBlackScholes(bs_params) << std::endl;
+		std::cout << financial_calculator.calculateMonteCarlo(mtc_params) << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	if (argc < 3)
+	{
+		std::cerr << "Usage: " << argv[0] << " <input> <output> [--greeks] [--binary-output] [--chunk-size N] [--queue-depth N]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		ChainStreamConfig config;
+		for (int i{ 3 }; i < argc; ++i)
+		{
+			if (std::strcmp(argv[i], "--greeks") == 0) config.greeks = true;
+			else if (std::strcmp(argv[i], "--binary-output") == 0) config.output_format = ChainOutputFormat::Binary;
+			else if (std::strcmp(argv[i], "--chunk-size") == 0 && i + 1 < argc) config.chunk_size = std::stoull(argv[++i]);
+			else if (std::strcmp(argv[i], "--queue-depth") == 0 && i + 1 < argc) config.queue_depth = std::stoull(argv[++i]);
+			else throw std::invalid_argument(std::string("[!] Unknown option ") + argv[i]);
+		}
+
+		const ChainStreamPricer pricer(config);
+		const ChainStreamStats stats = pricer.price(argv[1], argv[2]);
+		std::cout << "[+] Priced " << stats.records << " contracts in " << stats.chunks << " chunks" << std::endl;
+	}
+	catch (const std::exception& exception)
+	{
+		std::cerr << exception.what() << std::endl;
+		return EXIT_FAILURE;
+	}
 
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,143 @@
+﻿#include "mapped_file.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+	file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE)
+	{
+		file_ = nullptr;
+		throw std::runtime_error("[!] Can't open " + path);
+	}
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file_, &size))
+	{
+		unmap();
+		throw std::runtime_error("[!] Can't read the size of " + path);
+	}
+	size_ = static_cast<std::size_t>(size.QuadPart);
+	if (size_ == 0) return;
+
+	mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	data_ = mapping_ != nullptr ? static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+	if (data_ == nullptr)
+	{
+		unmap();
+		throw std::runtime_error("[!] Can't map " + path);
+	}
+}
+
+void MappedFile::releaseBefore(const std::size_t offset) noexcept
+{
+	// Unlocking pages that are not locked removes them from the working set of the process
+	if (data_ == nullptr || offset <= released_ + (1 << 20)) return;
+
+	VirtualUnlock(const_cast<char*>(data_) + released_, offset - released_);
+	released_ = offset;
+}
+
+void MappedFile::unmap() noexcept
+{
+	if (data_ != nullptr) UnmapViewOfFile(data_);
+	if (mapping_ != nullptr) CloseHandle(mapping_);
+	if (file_ != nullptr) CloseHandle(file_);
+	data_ = nullptr;
+	mapping_ = nullptr;
+	file_ = nullptr;
+	size_ = 0;
+	released_ = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+	const int descriptor = open(path.c_str(), O_RDONLY);
+	if (descriptor < 0) throw std::runtime_error("[!] Can't open " + path);
+
+	struct stat status {};
+	if (fstat(descriptor, &status) != 0)
+	{
+		close(descriptor);
+		throw std::runtime_error("[!] Can't read the size of " + path);
+	}
+
+	size_ = static_cast<std::size_t>(status.st_size);
+	if (size_ != 0)
+	{
+		void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (mapping == MAP_FAILED)
+		{
+			close(descriptor);
+			throw std::runtime_error("[!] Can't map " + path);
+		}
+		data_ = static_cast<const char*>(mapping);
+		madvise(mapping, size_, MADV_SEQUENTIAL);
+	}
+
+	close(descriptor);	// The mapping keeps the file alive
+}
+
+void MappedFile::releaseBefore(const std::size_t offset) noexcept
+{
+	const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	const std::size_t end = std::min(offset, size_) / page * page;
+	if (data_ == nullptr || end <= released_) return;
+
+	madvise(const_cast<char*>(data_) + released_, end - released_, MADV_DONTNEED);
+	released_ = end;
+}
+
+void MappedFile::unmap() noexcept
+{
+	if (data_ != nullptr) munmap(const_cast<char*>(data_), size_);
+	data_ = nullptr;
+	size_ = 0;
+	released_ = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		unmap();
+		std::swap(data_, other.data_);
+		std::swap(size_, other.size_);
+		std::swap(released_, other.released_);
+#ifdef _WIN32
+		std::swap(file_, other.file_);
+		std::swap(mapping_, other.mapping_);
+#endif
+	}
+	return *this;
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <string>
+
+/*
+*	Read-only memory mapping of a whole file (mmap on POSIX systems, a file mapping view on Windows)
+*
+*	-.The mapping is hinted for sequential access, pages are read from the page cache on demand as the data is touched
+*	-.releaseBefore(offset) tells the system the pages before offset won't be read again, so long sequential scans keep a flat
+*	resident footprint instead of accumulating the whole file
+*	-.An empty file maps to data() == nullptr and size() == 0
+*/
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	[[nodiscard]] inline const char* data() const noexcept { return data_; }
+	[[nodiscard]] inline std::size_t size() const noexcept { return size_; }
+
+	// @releaseBefore : Drops the resident pages entirely below offset (the data stays readable, it is just read again if touched)
+	void releaseBefore(std::size_t offset) noexcept;
+
+private:
+	const char* data_{};
+	std::size_t size_{};
+	std::size_t released_{};	// Bytes already released from the start of the mapping
+#ifdef _WIN32
+	void* file_{};
+	void* mapping_{};
+#endif
+
+	void unmap() noexcept;
+};
@@ -0,0 +1,271 @@
+﻿#include "metrics.h"
+
+#include <algorithm>
+#include <sstream>
+
+#if defined(FC_METRICS)
+#include <atomic>
+#include <memory>
+#include <mutex>
+#endif
+
+namespace
+{
+	constexpr const char* ENTRY_POINT_NAMES[METRICS_ENTRY_POINTS] =
+	{
+		"black_scholes", "black_scholes_chain", "greeks", "greeks_chain", "implied_volatility", "monte_carlo", "monte_carlo_simulation",
+		"strategy_payoff", "strategy_pricing", "scenario_grid", "scheduler_task",
+	};
+
+	constexpr const char* COUNTER_NAMES[METRICS_COUNTERS] = { "cache_hits", "cache_misses" };
+	constexpr const char* COUNTER_HELP[METRICS_COUNTERS] = { "Pricing cache lookups served from the cache", "Pricing cache lookups computed by the calculator" };
+
+#if defined(FC_METRICS)
+	using Clock = std::chrono::steady_clock;
+
+	// Counter written by its owner thread only, a relaxed load + store instead of a locked read-modify-write
+	struct OwnedCounter
+	{
+		std::atomic<std::uint64_t> value{ 0 };
+
+		inline void add(const std::uint64_t amount) noexcept { value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+		[[nodiscard]] inline std::uint64_t get() const noexcept { return value.load(std::memory_order_relaxed); }
+	};
+
+	struct EntryPointCounters
+	{
+		OwnedCounter calls{};
+		OwnedCounter errors{};
+		OwnedCounter items{};
+		OwnedCounter timed_calls{};
+		OwnedCounter latency_ns{};
+		std::array<OwnedCounter, METRICS_LATENCY_BUCKETS> latency_buckets{};
+	};
+
+	struct alignas(64) ThreadMetrics
+	{
+		std::array<EntryPointCounters, METRICS_ENTRY_POINTS> entry_points{};
+		std::array<OwnedCounter, METRICS_COUNTERS> counters{};
+		OwnedCounter busy_ns{};
+		std::size_t thread{};
+		Clock::time_point registered{ Clock::now() };
+	};
+
+	// Every live thread block, plus the totals of the threads already gone
+	struct MetricsRegistry
+	{
+		std::mutex mutex{};
+		std::vector<ThreadMetrics*> threads{};
+		MetricsSnapshot retired{};
+		std::size_t next_thread{ 0 };
+	};
+
+	[[nodiscard]] MetricsRegistry& registry()
+	{
+		static MetricsRegistry* instance = new MetricsRegistry();	// Never destroyed, threads may exit after the static destructors ran
+		return *instance;
+	}
+
+	void addInto(MetricsSnapshot& snapshot, const ThreadMetrics& metrics) noexcept
+	{
+		for (std::size_t i{ 0 }; i < METRICS_ENTRY_POINTS; ++i)
+		{
+			const EntryPointCounters& source = metrics.entry_points[i];
+			EntryPointMetrics& target = snapshot.entry_points[i];
+			target.calls += source.calls.get();
+			target.errors += source.errors.get();
+			target.items += source.items.get();
+			target.timed_calls += source.timed_calls.get();
+			target.latency_ns += source.latency_ns.get();
+			for (std::size_t bucket{ 0 }; bucket < METRICS_LATENCY_BUCKETS; ++bucket)
+			{
+				target.latency_buckets[bucket] += source.latency_buckets[bucket].get();
+			}
+		}
+		for (std::size_t i{ 0 }; i < METRICS_COUNTERS; ++i)
+		{
+			snapshot.counters[i] += metrics.counters[i].get();
+		}
+	}
+
+	// Registers the block of the calling thread on first use, folds it into the retired totals when the thread exits
+	class ThreadMetricsHandle
+	{
+	public:
+		ThreadMetricsHandle()
+		{
+			MetricsRegistry& metrics_registry = registry();
+			const std::lock_guard<std::mutex> lock(metrics_registry.mutex);
+			metrics_.thread = metrics_registry.next_thread++;
+			metrics_registry.threads.push_back(&metrics_);
+		}
+
+		~ThreadMetricsHandle()
+		{
+			MetricsRegistry& metrics_registry = registry();
+			const std::lock_guard<std::mutex> lock(metrics_registry.mutex);
+			addInto(metrics_registry.retired, metrics_);
+			metrics_registry.threads.erase(std::find(metrics_registry.threads.begin(), metrics_registry.threads.end(), &metrics_));
+		}
+
+		ThreadMetricsHandle(const ThreadMetricsHandle&) = delete;
+		ThreadMetricsHandle& operator=(const ThreadMetricsHandle&) = delete;
+
+		[[nodiscard]] inline ThreadMetrics& metrics() noexcept { return metrics_; }
+
+	private:
+		ThreadMetrics metrics_{};
+	};
+
+	[[nodiscard]] ThreadMetrics& threadMetrics() noexcept
+	{
+		thread_local ThreadMetricsHandle handle;
+		return handle.metrics();
+	}
+
+	[[nodiscard]] std::size_t latencyBucket(const std::uint64_t latency_ns) noexcept
+	{
+#if defined(__GNUC__)
+		const std::size_t bucket = latency_ns > 1 ? static_cast<std::size_t>(63 - __builtin_clzll(latency_ns)) : 0;
+#else
+		std::size_t bucket{ 0 };
+		for (std::uint64_t value{ latency_ns }; value > 1; value >>= 1) ++bucket;
+#endif
+		return std::min(bucket, METRICS_LATENCY_BUCKETS - 1);
+	}
+#endif
+}
+
+#if defined(FC_METRICS)
+
+void recordMetricsCall(const MetricsEntryPoint entry_point, const std::uint64_t latency_ns, const std::uint64_t items, const bool failed, const bool outermost,
+	const std::uint32_t weight) noexcept
+{
+	ThreadMetrics& metrics = threadMetrics();
+	EntryPointCounters& counters = metrics.entry_points[static_cast<std::size_t>(entry_point)];
+
+	counters.calls.add(1);
+	if (failed) counters.errors.add(1);
+	counters.items.add(items);
+	if (weight == 0) return;
+
+	counters.timed_calls.add(1);
+	counters.latency_ns.add(latency_ns);
+	counters.latency_buckets[latencyBucket(latency_ns)].add(1);
+	if (outermost) metrics.busy_ns.add(weight * latency_ns);
+}
+
+void recordMetricsCounter(const MetricsCounter counter, const std::uint64_t count) noexcept
+{
+	threadMetrics().counters[static_cast<std::size_t>(counter)].add(count);
+}
+
+#endif
+
+[[nodiscard]] MetricsSnapshot metricsSnapshot()
+{
+	MetricsSnapshot snapshot;
+
+#if defined(FC_METRICS)
+	MetricsRegistry& metrics_registry = registry();
+	const Clock::time_point now = Clock::now();
+	{
+		const std::lock_guard<std::mutex> lock(metrics_registry.mutex);
+		snapshot = metrics_registry.retired;
+		for (const ThreadMetrics* metrics : metrics_registry.threads)
+		{
+			addInto(snapshot, *metrics);
+
+			ThreadUtilization utilization;
+			utilization.thread = metrics->thread;
+			utilization.busy_seconds = static_cast<double>(metrics->busy_ns.get()) * 1e-9;
+			utilization.lifetime_seconds = std::chrono::duration<double>(now - metrics->registered).count();
+			utilization.utilization = utilization.lifetime_seconds > 0 ? std::min(utilization.busy_seconds / utilization.lifetime_seconds, 1.0) : 0.0;
+			snapshot.threads.push_back(utilization);
+		}
+	}
+
+	const EntryPointMetrics& simulation = snapshot[MetricsEntryPoint::MonteCarloSimulation];
+	snapshot.monte_carlo_paths_per_second = simulation.latency_ns != 0 ? static_cast<double>(simulation.items) * 1e9 / static_cast<double>(simulation.latency_ns) : 0.0;
+
+	const std::uint64_t lookups = snapshot[MetricsCounter::CacheHits] + snapshot[MetricsCounter::CacheMisses];
+	snapshot.cache_hit_rate = lookups != 0 ? static_cast<double>(snapshot[MetricsCounter::CacheHits]) / static_cast<double>(lookups) : 0.0;
+#endif
+
+	return snapshot;
+}
+
+[[nodiscard]] const char* metricsEntryPointName(const MetricsEntryPoint entry_point) noexcept
+{
+	const auto index = static_cast<std::size_t>(entry_point);
+	return index < METRICS_ENTRY_POINTS ? ENTRY_POINT_NAMES[index] : "unknown";
+}
+
+/*
+	@formatPrometheus: One family per quantity, the entry points (and threads) as labels
+	-.fc_calls_total / fc_errors_total / fc_items_total counters and the fc_latency_seconds histogram (cumulative le buckets) per entry point
+	-.fc_cache_hits_total / fc_cache_misses_total counters, fc_cache_hit_rate and fc_monte_carlo_paths_per_second gauges
+	-.fc_thread_busy_seconds_total counter and fc_thread_utilization gauge per live thread
+*/
+[[nodiscard]] std::string formatPrometheus(const MetricsSnapshot& snapshot)
+{
+	std::ostringstream out;
+
+	const auto family = [&out](const char* name, const char* type, const char* help)
+	{
+		out << "# HELP " << name << ' ' << help << '\n' << "# TYPE " << name << ' ' << type << '\n';
+	};
+
+	const auto per_entry_point = [&](const char* name, const char* help, std::uint64_t EntryPointMetrics::* field)
+	{
+		family(name, "counter", help);
+		for (std::size_t i{ 0 }; i < METRICS_ENTRY_POINTS; ++i)
+		{
+			out << name << "{entry_point=\"" << ENTRY_POINT_NAMES[i] << "\"} " << snapshot.entry_points[i].*field << '\n';
+		}
+	};
+
+	per_entry_point("fc_calls_total", "Calls of the entry point", &EntryPointMetrics::calls);
+	per_entry_point("fc_errors_total", "Calls of the entry point left by an exception", &EntryPointMetrics::errors);
+	per_entry_point("fc_items_total", "Contracts, quotes, paths or legs processed by the entry point", &EntryPointMetrics::items);
+
+	family("fc_latency_seconds", "histogram", "Latency of the timed calls of the entry point (a sample of the scalar closed forms)");
+	for (std::size_t i{ 0 }; i < METRICS_ENTRY_POINTS; ++i)
+	{
+		const EntryPointMetrics& metrics = snapshot.entry_points[i];
+		std::uint64_t cumulative{ 0 };
+		for (std::size_t bucket{ 0 }; bucket + 1 < METRICS_LATENCY_BUCKETS; ++bucket)
+		{
+			cumulative += metrics.latency_buckets[bucket];
+			out << "fc_latency_seconds_bucket{entry_point=\"" << ENTRY_POINT_NAMES[i] << "\",le=\"" << static_cast<double>(std::uint64_t{ 2 } << bucket) * 1e-9 << "\"} " << cumulative << '\n';
+		}
+		out << "fc_latency_seconds_bucket{entry_point=\"" << ENTRY_POINT_NAMES[i] << "\",le=\"+Inf\"} " << metrics.timed_calls << '\n';
+		out << "fc_latency_seconds_sum{entry_point=\"" << ENTRY_POINT_NAMES[i] << "\"} " << static_cast<double>(metrics.latency_ns) * 1e-9 << '\n';
+		out << "fc_latency_seconds_count{entry_point=\"" << ENTRY_POINT_NAMES[i] << "\"} " << metrics.timed_calls << '\n';
+	}
+
+	for (std::size_t i{ 0 }; i < METRICS_COUNTERS; ++i)
+	{
+		const std::string name = std::string("fc_") + COUNTER_NAMES[i] + "_total";
+		family(name.c_str(), "counter", COUNTER_HELP[i]);
+		out << name << ' ' << snapshot.counters[i] << '\n';
+	}
+
+	family("fc_cache_hit_rate", "gauge", "Share of the pricing cache lookups served from the cache");
+	out << "fc_cache_hit_rate " << snapshot.cache_hit_rate << '\n';
+	family("fc_monte_carlo_paths_per_second", "gauge", "Monte Carlo paths simulated per second of simulation of a thread");
+	out << "fc_monte_carlo_paths_per_second " << snapshot.monte_carlo_paths_per_second << '\n';
+
+	family("fc_thread_busy_seconds_total", "counter", "Time spent by the thread in instrumented calls and scheduler tasks");
+	for (const auto& thread : snapshot.threads)
+	{
+		out << "fc_thread_busy_seconds_total{thread=\"" << thread.thread << "\"} " << thread.busy_seconds << '\n';
+	}
+	family("fc_thread_utilization", "gauge", "Busy share of the lifetime of the thread");
+	for (const auto& thread : snapshot.threads)
+	{
+		out << "fc_thread_utilization{thread=\"" << thread.thread << "\"} " << thread.utilization << '\n';
+	}
+
+	return out.str();
+}
@@ -0,0 +1,168 @@
+﻿#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(FC_METRICS)
+#include <chrono>
+#include <exception>
+#endif
+
+/*
+*	Optional instrumentation of the pricing hot paths, compiled in with -DFC_METRICS
+*
+*	-.Every instrumented entry point counts its calls, failed calls (left by an exception), processed items (contracts of a chain,
+*	Monte Carlo paths) and its latency in a histogram of power of two nanosecond buckets
+*	-.The counters live in a block owned by each thread: the hot path only does relaxed loads / stores on its own cache lines, no lock
+*	and no contended atomic, metricsSnapshot() sums the blocks of the live threads and of the ones already gone
+*	-.Two clock reads cost about as much as a scalar closed form, those entry points time one call in METRICS_LATENCY_SAMPLING (their
+*	histogram is the one of a sample of the calls, every call is still counted), the chain pricers, Monte Carlo and tasks time every call
+*	-.Busy time is the time a thread spends in its outermost instrumented scope (an entry point, a scheduler task), its utilization is
+*	the busy share of its lifetime (the sampled calls count for METRICS_LATENCY_SAMPLING times their latency)
+*	-.Without FC_METRICS the FC_METRICS_* macros expand to nothing, metricsSnapshot() returns an empty snapshot (enabled == false)
+*/
+
+constexpr bool METRICS_ENABLED =
+#if defined(FC_METRICS)
+	true;
+#else
+	false;
+#endif
+
+enum class MetricsEntryPoint : std::uint8_t
+{
+	BlackScholes,		// FinancialCalculator::calculateBlackScholes of one contract
+	BlackScholesChain,	// FinancialCalculator::calculateBlackScholes of a chain (items: contracts)
+	Greeks,			// FinancialCalculator::calculateGreeks of one contract (one greek or all of them)
+	GreeksChain,		// FinancialCalculator::calculateGreeks of a chain (items: contracts)
+	ImpliedVolatility,	// FinancialCalculator::calculateImpliedVolatility of one quote or a chain (items: quotes)
+	MonteCarlo,		// FinancialCalculator::calculateMonteCarloEstimate (items: paths)
+	MonteCarloSimulation,	// Path simulation of a Monte Carlo worker or task (items: paths), for the paths/s per thread
+	StrategyPayoff,		// CalculateStrategy / MultiLegStrategy payoffs (items: spot prices)
+	StrategyPricing,	// MultiLegStrategy Black-Scholes value and Greeks (items: legs)
+	ScenarioGrid,		// ScenarioGrid::price (items: contract scenarios)
+	SchedulerTask,		// Task run by a TaskScheduler worker
+	Count,
+};
+
+enum class MetricsCounter : std::uint8_t
+{
+	CacheHits,		// PricingCache lookups served from the cache
+	CacheMisses,		// PricingCache lookups computed by the calculator
+	Count,
+};
+
+constexpr std::size_t METRICS_ENTRY_POINTS = static_cast<std::size_t>(MetricsEntryPoint::Count);
+constexpr std::size_t METRICS_COUNTERS = static_cast<std::size_t>(MetricsCounter::Count);
+constexpr std::uint32_t METRICS_LATENCY_SAMPLING = 16;	// One timed call out of this many for the scalar closed forms
+constexpr std::size_t METRICS_LATENCY_BUCKETS = 40;	// Bucket b counts the calls of [2^b, 2^(b+1)) ns, the last one everything above (~9 minutes)
+
+struct EntryPointMetrics
+{
+	std::uint64_t calls{};
+	std::uint64_t errors{};
+	std::uint64_t items{};
+	std::uint64_t timed_calls{};	// Calls whose latency was measured (all of them, or the sample of the scalar entry points)
+	std::uint64_t latency_ns{};	// Total latency of the timed calls
+	std::array<std::uint64_t, METRICS_LATENCY_BUCKETS> latency_buckets{};
+};
+
+struct ThreadUtilization
+{
+	std::size_t thread{};		// Registration order of the thread (the first instrumented call on it)
+	double busy_seconds{};
+	double lifetime_seconds{};	// Since the registration
+	double utilization{};		// busy_seconds / lifetime_seconds
+};
+
+struct MetricsSnapshot
+{
+	bool enabled{ METRICS_ENABLED };
+	std::array<EntryPointMetrics, METRICS_ENTRY_POINTS> entry_points{};
+	std::array<std::uint64_t, METRICS_COUNTERS> counters{};
+	double monte_carlo_paths_per_second{};	// Paths simulated per second of simulation, per thread
+	double cache_hit_rate{};		// CacheHits / (CacheHits + CacheMisses), 0 before the first lookup
+	std::vector<ThreadUtilization> threads{};	// Live threads only
+
+	[[nodiscard]] inline const EntryPointMetrics& operator[](const MetricsEntryPoint entry_point) const noexcept { return entry_points[static_cast<std::size_t>(entry_point)]; }
+	[[nodiscard]] inline std::uint64_t operator[](const MetricsCounter counter) const noexcept { return counters[static_cast<std::size_t>(counter)]; }
+};
+
+// @metricsSnapshot : Totals since the start of the process, safe to call from any thread while the instrumented code runs
+[[nodiscard]] MetricsSnapshot metricsSnapshot();
+
+// @formatPrometheus : Snapshot in the Prometheus text exposition format (fc_* metric families, the entry points as labels)
+[[nodiscard]] std::string formatPrometheus(const MetricsSnapshot& snapshot);
+
+// @metricsEntryPointName : snake_case label of an entry point (black_scholes, greeks_chain...)
+[[nodiscard]] const char* metricsEntryPointName(MetricsEntryPoint entry_point) noexcept;
+
+#if defined(FC_METRICS)
+
+// @recordMetricsCall : Adds one call of entry_point, timed calls (weight != 0) add latency_ns to the histogram and weight * latency_ns to the busy time of outermost ones
+void recordMetricsCall(MetricsEntryPoint entry_point, std::uint64_t latency_ns, std::uint64_t items, bool failed, bool outermost, std::uint32_t weight) noexcept;
+void recordMetricsCounter(MetricsCounter counter, std::uint64_t count) noexcept;
+
+// Instrumented scopes open on the calling thread (only the outermost one adds to the busy time) and its sampling tick
+struct MetricsThreadState
+{
+	int depth{};
+	std::uint32_t tick{};
+};
+
+[[nodiscard]] inline MetricsThreadState& metricsThreadState() noexcept
+{
+	thread_local MetricsThreadState state;
+	return state;
+}
+
+// Counts the enclosing scope as one call of an entry point, timing one call in sampling
+class MetricsScope
+{
+public:
+	explicit MetricsScope(const MetricsEntryPoint entry_point, const std::uint32_t sampling = 1) noexcept
+		: entry_point_(entry_point), exceptions_(std::uncaught_exceptions())
+	{
+		MetricsThreadState& state = metricsThreadState();
+		outermost_ = state.depth++ == 0;
+		weight_ = sampling == 1 || ++state.tick % sampling == 0 ? sampling : 0;
+		if (weight_ != 0) start_ = std::chrono::steady_clock::now();
+	}
+
+	~MetricsScope()
+	{
+		--metricsThreadState().depth;
+		const auto latency = weight_ != 0 ? std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count() : 0;
+		recordMetricsCall(entry_point_, static_cast<std::uint64_t>(latency), items_, std::uncaught_exceptions() > exceptions_, outermost_, weight_);
+	}
+
+	MetricsScope(const MetricsScope&) = delete;
+	MetricsScope& operator=(const MetricsScope&) = delete;
+
+	inline void addItems(const std::uint64_t items) noexcept { items_ += items; }
+
+private:
+	MetricsEntryPoint entry_point_;
+	int exceptions_;
+	bool outermost_{};
+	std::uint32_t weight_{};
+	std::chrono::steady_clock::time_point start_{};
+	std::uint64_t items_{};
+};
+
+#define FC_METRICS_SCOPE(entry_point) MetricsScope fc_metrics_scope_(MetricsEntryPoint::entry_point)
+#define FC_METRICS_SCOPE_SAMPLED(entry_point) MetricsScope fc_metrics_scope_(MetricsEntryPoint::entry_point, METRICS_LATENCY_SAMPLING)
+#define FC_METRICS_ITEMS(items) fc_metrics_scope_.addItems(static_cast<std::uint64_t>(items))
+#define FC_METRICS_COUNT(counter, count) recordMetricsCounter(MetricsCounter::counter, static_cast<std::uint64_t>(count))
+
+#else
+
+#define FC_METRICS_SCOPE(entry_point) static_cast<void>(0)
+#define FC_METRICS_SCOPE_SAMPLED(entry_point) static_cast<void>(0)
+#define FC_METRICS_ITEMS(items) static_cast<void>(0)
+#define FC_METRICS_COUNT(counter, count) static_cast<void>(0)
+
+#endif
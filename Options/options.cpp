@@ -1,27 +1,127 @@
 ﻿#include "options.h"
+#include "simd.h"
+#include "quasi_random.h"
+#include "constexpr_math.h"
+#include "metrics.h"
+#include "gpu_backend.h"
 
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+
+// @calculateBlackScholes : Runtime dispatch to the specialization of params.option_type
 [[nodiscard]] double FinancialCalculator::calculateBlackScholes(const BlackScholesParams& params) const
 {
-	const auto d1 = (log(params.underlying_price / params.strike_price) + (params.interest_rate + (params.volatility * params.volatility) / 2.0) * params.time) / (params.volatility * std::sqrt(params.time));
-	const auto d2 = d1 - params.volatility * std::sqrt(params.time);
+	FC_METRICS_SCOPE_SAMPLED(BlackScholes);
 
 	switch (params.option_type)
 	{
 	case OptionType::Call:
-		return params.underlying_price * normalCdf(d1) - params.strike_price * std::exp(-params.interest_rate * params.time) * normalCdf(d2);
+		return calculateBlackScholes<OptionType::Call>(params);
 	case OptionType::Put:
-		return params.strike_price * std::exp(-params.interest_rate * params.time) * normalCdf(-d2) - params.underlying_price * normalCdf(-d1);
+		return calculateBlackScholes<OptionType::Put>(params);
 	default:
 		throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
 	}
 }
 
-[[nodiscard]] inline double FinancialCalculator::calculateFutures(const FuturesParams& params) const
+// @calculateBlackScholes<Type> : Black-Scholes price of a Call / Put known at compile time (params.option_type is not read)
+template<OptionType Type>
+[[nodiscard]] Price FinancialCalculator::calculateBlackScholes(const BlackScholesParams& params) const noexcept
+{
+	const auto d1 = (log(params.underlying_price / params.strike_price) + (params.interest_rate + (params.volatility * params.volatility) / 2.0) * params.time) / (params.volatility * std::sqrt(params.time));
+	const auto d2 = d1 - params.volatility * std::sqrt(params.time);
+
+	if constexpr (Type == OptionType::Call)
+	{
+		return params.underlying_price * normalCdf(d1) - params.strike_price * std::exp(-params.interest_rate * params.time) * normalCdf(d2);
+	}
+	else
+	{
+		return params.strike_price * std::exp(-params.interest_rate * params.time) * normalCdf(-d2) - params.underlying_price * normalCdf(-d1);
+	}
+}
+
+template Price FinancialCalculator::calculateBlackScholes<OptionType::Call>(const BlackScholesParams& params) const noexcept;
+template Price FinancialCalculator::calculateBlackScholes<OptionType::Put>(const BlackScholesParams& params) const noexcept;
+
+// Batch kernels of the compute backend, the CPU ones unless the device takes (and manages) the chain
+void FinancialCalculator::priceChainBlackScholes(const OptionChain& chain, Price* prices) const noexcept
+{
+	if (compute_backend_ == ComputeBackend::Gpu && chain.size >= GPU_MIN_CHAIN_SIZE && gpuBlackScholesBatch(chain, prices)) return;
+	calculateBlackScholesBatch(chain, prices);
+}
+
+void FinancialCalculator::priceChainGreeks(const OptionChain& chain, const OptionGreeksChain& greeks) const noexcept
+{
+	if (compute_backend_ == ComputeBackend::Gpu && chain.size >= GPU_MIN_CHAIN_SIZE && gpuGreeksBatch(chain, greeks)) return;
+	calculateGreeksBatch(chain, greeks);
+}
+
+/*
+	@calculateBlackScholes (batch): Prices a whole chain, prices must point to at least chain.size elements
+	-.The option types are validated once up front, so the pricing loop itself never throws
+	-.The pricing loop runs on the vectorized kernels of simd.h (widest instruction set available at runtime)
+	-.Calls and puts share the same branch-free formula through a ±1 sign:
+		-. Call : S * N(d1) - K * e^(-rT) * N(d2)
+		-. Put  : K * e^(-rT) * N(-d2) - S * N(-d1) = -(S * N(-d1) - K * e^(-rT) * N(-d2))
+*/
+void FinancialCalculator::calculateBlackScholes(const OptionChain& chain, Price* prices) const
+{
+	FC_METRICS_SCOPE(BlackScholesChain);
+	FC_METRICS_ITEMS(chain.size);
+
+	for (std::size_t i{ 0 }; i < chain.size; ++i)
+	{
+		if (chain.option_type[i] != OptionType::Call && chain.option_type[i] != OptionType::Put)
+		{
+			throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+		}
+	}
+
+	priceChainBlackScholes(chain, prices);
+}
+
+/*
+	@calculateBlackScholesApproximate: Fast approximate pricing mode, calculateBlackScholes with N read from the compile-time
+	table of constexpr_math.h instead of evaluated through erfc
+	-.Every N(·) is within NormalCdfTable<>::MAX_ERROR (8.7e-11), so the price is within (S + K * e^(-rT)) * 8.7e-11 of calculateBlackScholes
+*/
+[[nodiscard]] Price FinancialCalculator::calculateBlackScholesApproximate(const BlackScholesParams& params) const
 {
-	return params.present_value * std::pow(1 + params.interest_rate, params.time);
+	if (params.option_type != OptionType::Call && params.option_type != OptionType::Put) throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+
+	const auto volatility_sqrt_time = params.volatility * std::sqrt(params.time);
+	const auto d1 = (log(params.underlying_price / params.strike_price) + (params.interest_rate + (params.volatility * params.volatility) / 2.0) * params.time) / volatility_sqrt_time;
+	const auto d2 = d1 - volatility_sqrt_time;
+
+	const double sign = params.option_type == OptionType::Call ? 1.0 : -1.0;
+	return sign * (params.underlying_price * NORMAL_CDF_TABLE(sign * d1) - params.strike_price * std::exp(-params.interest_rate * params.time) * NORMAL_CDF_TABLE(sign * d2));
 }
 
+// @calculateGreeks : Runtime dispatch to the specialization of greek and params.option_type (anything but a Call is priced as a Put)
 [[nodiscard]] double FinancialCalculator::calculateGreeks(const GreeksParams& params, const Greeks greek) const
+{
+	FC_METRICS_SCOPE_SAMPLED(Greeks);
+
+	const bool call = params.option_type == OptionType::Call;
+
+	switch (greek)
+	{
+		case Greeks::Delta : return call ? calculateGreeks<Greeks::Delta, OptionType::Call>(params) : calculateGreeks<Greeks::Delta, OptionType::Put>(params);
+		case Greeks::Gamma : return call ? calculateGreeks<Greeks::Gamma, OptionType::Call>(params) : calculateGreeks<Greeks::Gamma, OptionType::Put>(params);
+		case Greeks::Theta : return call ? calculateGreeks<Greeks::Theta, OptionType::Call>(params) : calculateGreeks<Greeks::Theta, OptionType::Put>(params);
+		case Greeks::Vega : return call ? calculateGreeks<Greeks::Vega, OptionType::Call>(params) : calculateGreeks<Greeks::Vega, OptionType::Put>(params);
+		case Greeks::Rho : return call ? calculateGreeks<Greeks::Rho, OptionType::Call>(params) : calculateGreeks<Greeks::Rho, OptionType::Put>(params);
+		default:
+			throw std::invalid_argument("[!] Invalid Greek specified");
+	}
+}
+
+// @calculateGreeks<Greek, Type> : One greek of a Call / Put, both known at compile time (params.option_type is not read)
+template<Greeks Greek, OptionType Type>
+[[nodiscard]] double FinancialCalculator::calculateGreeks(const GreeksParams& params) const
 {
 	if (params.time <= 0) throw std::runtime_error("[!] Time must be positive");
 	if (params.volatility <= 0) throw std::runtime_error("[!] Volatility must be positive");
@@ -32,46 +132,353 @@
 	const auto discount = std::exp(-params.interest_rate * params.time);		// Measures the present value of $1 to be received at a future date
 	const auto dividend_discount = std::exp(-params.dividend_yield * params.time);  // It's similar to discount, but it's based on the dividend yield instead of the interest rate
 
-	switch (greek)
+	constexpr bool call = Type == OptionType::Call;
+
+	if constexpr (Greek == Greeks::Delta)
+	{
+		return call ?
+			dividend_discount * normalCdf(d1) :
+			dividend_discount * (normalCdf(d1) - 1);
+	}
+	else if constexpr (Greek == Greeks::Gamma)
+	{
+		return (dividend_discount * normalPdf(d1)) / (params.underlying_price * params.volatility * std::sqrt(params.time));
+	}
+	else if constexpr (Greek == Greeks::Theta)
+	{
+		const double theta_part1 = -(params.underlying_price * params.volatility * dividend_discount * normalPdf(d1)) / (2 * std::sqrt(params.time));
+		const double theta_part2 = call ?
+			-params.interest_rate * params.strike_price * discount * normalCdf(d2) + params.dividend_yield * params.underlying_price * dividend_discount * normalCdf(d1) :
+			params.interest_rate * params.strike_price * discount * normalCdf(-d2) - params.dividend_yield * params.underlying_price * dividend_discount * normalCdf(-d1);
+
+		return theta_part1 + theta_part2;
+	}
+	else if constexpr (Greek == Greeks::Vega)
+	{
+		return params.underlying_price * dividend_discount * normalPdf(d1) * std::sqrt(params.time);
+	}
+	else
+	{
+		static_assert(Greek == Greeks::Rho, "[!] Invalid Greek specified");
+		return call ?
+			params.strike_price * params.time * discount * normalCdf(d2) :
+			-params.strike_price * params.time * discount * normalCdf(-d2);
+	}
+}
+
+template double FinancialCalculator::calculateGreeks<Greeks::Delta, OptionType::Call>(const GreeksParams& params) const;
+template double FinancialCalculator::calculateGreeks<Greeks::Delta, OptionType::Put>(const GreeksParams& params) const;
+template double FinancialCalculator::calculateGreeks<Greeks::Gamma, OptionType::Call>(const GreeksParams& params) const;
+template double FinancialCalculator::calculateGreeks<Greeks::Gamma, OptionType::Put>(const GreeksParams& params) const;
+template double FinancialCalculator::calculateGreeks<Greeks::Theta, OptionType::Call>(const GreeksParams& params) const;
+template double FinancialCalculator::calculateGreeks<Greeks::Theta, OptionType::Put>(const GreeksParams& params) const;
+template double FinancialCalculator::calculateGreeks<Greeks::Vega, OptionType::Call>(const GreeksParams& params) const;
+template double FinancialCalculator::calculateGreeks<Greeks::Vega, OptionType::Put>(const GreeksParams& params) const;
+template double FinancialCalculator::calculateGreeks<Greeks::Rho, OptionType::Call>(const GreeksParams& params) const;
+template double FinancialCalculator::calculateGreeks<Greeks::Rho, OptionType::Put>(const GreeksParams& params) const;
+
+/*
+	@calculateGreeks (all): Price and every greek of the option from one evaluation of the shared terms
+	-.d1, d2, discount, dividend_discount, N(±d1), N(±d2) and φ(d1) are computed once and reused by every greek
+	-.Validation and the option type dispatch happen in the wrapper, the specialization below does the math
+	-.Each greek matches calculateGreeks(params, greek), the price is S * e^(-qT) * N(d1) - K * e^(-rT) * N(d2) for calls
+	(K * e^(-rT) * N(-d2) - S * e^(-qT) * N(-d1) for puts), which is calculateBlackScholes when there are no dividends
+*/
+[[nodiscard]] OptionGreeks FinancialCalculator::calculateGreeks(const GreeksParams& params) const
+{
+	FC_METRICS_SCOPE_SAMPLED(Greeks);
+
+	switch (params.option_type)
+	{
+	case OptionType::Call:
+		return calculateGreeks<OptionType::Call>(params);
+	case OptionType::Put:
+		return calculateGreeks<OptionType::Put>(params);
+	default:
+		throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+	}
+}
+
+// @calculateGreeks<Type> (all): Price and every greek of a Call / Put known at compile time (params.option_type is not read)
+template<OptionType Type>
+[[nodiscard]] OptionGreeks FinancialCalculator::calculateGreeks(const GreeksParams& params) const
+{
+	if (params.time <= 0) throw std::runtime_error("[!] Time must be positive");
+	if (params.volatility <= 0) throw std::runtime_error("[!] Volatility must be positive");
+
+	const auto sqrt_time = std::sqrt(params.time);
+	const auto d1 = (log(params.underlying_price / params.strike_price) + (params.interest_rate + (params.volatility * params.volatility) / 2.0) * params.time) / (params.volatility * sqrt_time);
+	const auto d2 = d1 - params.volatility * sqrt_time;
+
+	const auto discount = std::exp(-params.interest_rate * params.time);
+	const auto dividend_discount = std::exp(-params.dividend_yield * params.time);
+
+	// With sign = ±1 every call / put formula becomes the same expression of N(sign * d1) and N(sign * d2)
+	constexpr double sign = Type == OptionType::Call ? 1.0 : -1.0;
+	const double cdf_d1 = normalCdf(sign * d1);
+	const double cdf_d2 = normalCdf(sign * d2);
+	const double pdf_d1 = normalPdf(d1);
+
+	const double spot_term = params.underlying_price * dividend_discount;	// S * e^(-qT)
+	const double strike_term = params.strike_price * discount;		// K * e^(-rT)
+
+	OptionGreeks greeks;
+	greeks.price = sign * (spot_term * cdf_d1 - strike_term * cdf_d2);
+	greeks.delta = sign * dividend_discount * cdf_d1;
+	greeks.gamma = (dividend_discount * pdf_d1) / (params.underlying_price * params.volatility * sqrt_time);
+	greeks.theta = -(spot_term * params.volatility * pdf_d1) / (2 * sqrt_time) - sign * (params.interest_rate * strike_term * cdf_d2 - params.dividend_yield * spot_term * cdf_d1);
+	greeks.vega = spot_term * pdf_d1 * sqrt_time;
+	greeks.rho = sign * strike_term * params.time * cdf_d2;
+
+	return greeks;
+}
+
+template OptionGreeks FinancialCalculator::calculateGreeks<OptionType::Call>(const GreeksParams& params) const;
+template OptionGreeks FinancialCalculator::calculateGreeks<OptionType::Put>(const GreeksParams& params) const;
+
+/*
+	@calculateGreeks (batch): Price and every greek of each contract of the chain, written column by column into greeks
+	-.The whole chain is validated first (positive time and volatility, Call / Put types), then the vectorized kernel of simd.h
+	evaluates the shared terms once per contract
+*/
+void FinancialCalculator::calculateGreeks(const OptionChain& chain, const OptionGreeksChain& greeks) const
+{
+	FC_METRICS_SCOPE(GreeksChain);
+	FC_METRICS_ITEMS(chain.size);
+
+	for (std::size_t i{ 0 }; i < chain.size; ++i)
+	{
+		if (chain.time[i] <= 0) throw std::runtime_error("[!] Time must be positive");
+		if (chain.volatility[i] <= 0) throw std::runtime_error("[!] Volatility must be positive");
+		if (chain.option_type[i] != OptionType::Call && chain.option_type[i] != OptionType::Put)
+		{
+			throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+		}
+	}
+
+	priceChainGreeks(chain, greeks);
+}
+
+namespace
+{
+	/*
+		@solveImpliedVolatility : σ such that the Black-Scholes price (no dividends) equals target, NaN when target is outside the
+		no-arbitrage bounds of the option
+		-.Newton steps use the vega S * φ(d1) * √T, every iteration also tightens a bracket [low, high] of the root (the price grows
+		with σ), a step leaving the bracket is replaced by a bisection (or a doubling while there is no upper bound yet)
+		-.Starts from guess when it is positive, otherwise from the Corrado-Miller approximation, and stops once a step moves σ by less
+		than 1e-12 in relative terms
+	*/
+	[[nodiscard]] Volatility solveImpliedVolatility(const Price target, const Price spot, const Price strike, const Time time, const InterestRate rate,
+		const OptionType option_type, const Volatility guess) noexcept
 	{
-		case Greeks::Delta :
+		constexpr int MAX_ITERATIONS = 100;
+		constexpr double MIN_VOLATILITY = 1e-4;
+		constexpr double MAX_VOLATILITY = 5.0;
+
+		const double sign = option_type == OptionType::Call ? 1.0 : -1.0;
+		const double sqrt_time = std::sqrt(time);
+		const double strike_discount = strike * std::exp(-rate * time);
+		const double log_moneyness = std::log(spot / strike) + rate * time;	// ln(S / K) + rT
+
+		// Prices at σ → 0 (discounted intrinsic value) and σ → ∞ (S for calls, K * e^(-rT) for puts)
+		const double lower_bound = std::max(sign * (spot - strike_discount), 0.0);
+		const double upper_bound = option_type == OptionType::Call ? spot : strike_discount;
+		if (!(target > lower_bound && target < upper_bound)) return std::numeric_limits<double>::quiet_NaN();
+
+		double volatility = guess;
+		if (!(volatility > 0.0 && std::isfinite(volatility)))
+		{
+			const double call_price = option_type == OptionType::Call ? target : target + spot - strike_discount;	// Put-call parity
+			const double half_intrinsic = call_price - (spot - strike_discount) / 2.0;
+			const double radicand = std::max(half_intrinsic * half_intrinsic - (spot - strike_discount) * (spot - strike_discount) / MATH_PI, 0.0);
+			volatility = std::sqrt(2.0 * MATH_PI) / (spot + strike_discount) * (half_intrinsic + std::sqrt(radicand)) / sqrt_time;
+			volatility = std::clamp(volatility, MIN_VOLATILITY, MAX_VOLATILITY);
+		}
+
+		double low{ 0.0 };
+		double high{ std::numeric_limits<double>::infinity() };
+
+		for (int iteration{ 0 }; iteration < MAX_ITERATIONS; ++iteration)
 		{
-			return params.option_type == OptionType::Call ?
-				dividend_discount * normalCdf(d1) :
-				dividend_discount * (normalCdf(d1) - 1);
+			const double volatility_sqrt_time = volatility * sqrt_time;
+			const double d1 = log_moneyness / volatility_sqrt_time + volatility_sqrt_time / 2.0;
+			const double d2 = d1 - volatility_sqrt_time;
+
+			const double difference = sign * (spot * normalCdf(sign * d1) - strike_discount * normalCdf(sign * d2)) - target;
+			if (difference == 0.0) break;
+
+			if (difference > 0.0) high = volatility;
+			else low = volatility;
+
+			const double vega = spot * normalPdf(d1) * sqrt_time;
+			double next = volatility - difference / vega;
+			if (!(next > low && next < high))
+			{
+				next = std::isinf(high) ? 2.0 * volatility : 0.5 * (low + high);
+			}
+			if (std::fabs(next - volatility) <= 1e-12 * volatility)	// Converged in relative terms (deep out of the money prices only fix σ loosely)
+			{
+				volatility = next;
+				break;
+			}
+			volatility = next;
 		}
-		case Greeks::Gamma :
+
+		return volatility;
+	}
+}
+
+/*
+	@calculateImpliedVolatility: Volatility for which calculateBlackScholes(params) equals params.paid_price
+	-.params.volatility is the starting point of the solver (e.g. the previous tick's implied volatility), 0 lets the solver pick one
+	-.Throws when the paid price is outside of the no-arbitrage bounds (no volatility can reproduce it)
+*/
+[[nodiscard]] Volatility FinancialCalculator::calculateImpliedVolatility(const BlackScholesParams& params) const
+{
+	FC_METRICS_SCOPE(ImpliedVolatility);
+	FC_METRICS_ITEMS(1);
+
+	if (params.time <= 0) throw std::runtime_error("[!] Time must be positive");
+	if (params.option_type != OptionType::Call && params.option_type != OptionType::Put) throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+
+	const Volatility volatility = solveImpliedVolatility(params.paid_price, params.underlying_price, params.strike_price, params.time, params.interest_rate,
+		params.option_type, params.volatility);
+	if (std::isnan(volatility)) throw std::runtime_error("[!] The paid price is outside of the no-arbitrage bounds of the option");
+
+	return volatility;
+}
+
+/*
+	@calculateImpliedVolatility (batch): volatilities[i] = implied volatility of contract i quoted at paid_prices[i]
+	-.The volatility column of the chain holds the warm starts (e.g. the previous tick's solution), non positive entries let the solver pick one
+	-.The chain is validated up front (positive time, Call / Put), a quote outside of its no-arbitrage bounds gets a NaN volatility
+	instead of aborting the whole batch
+	-.volatilities may alias chain.volatility, every entry is only read before its own solution is written
+*/
+void FinancialCalculator::calculateImpliedVolatility(const OptionChain& chain, const Price* paid_prices, Volatility* volatilities) const
+{
+	FC_METRICS_SCOPE(ImpliedVolatility);
+	FC_METRICS_ITEMS(chain.size);
+
+	for (std::size_t i{ 0 }; i < chain.size; ++i)
+	{
+		if (chain.time[i] <= 0) throw std::runtime_error("[!] Time must be positive");
+		if (chain.option_type[i] != OptionType::Call && chain.option_type[i] != OptionType::Put)
 		{
-			return (dividend_discount * normalPdf(d1)) / (params.underlying_price * params.volatility * std::sqrt(params.time));
+			throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
 		}
-		case Greeks::Theta : 
+	}
+
+	for (std::size_t i{ 0 }; i < chain.size; ++i)
+	{
+		volatilities[i] = solveImpliedVolatility(paid_prices[i], chain.underlying_price[i], chain.strike_price[i], chain.time[i], chain.interest_rate[i],
+			chain.option_type[i], chain.volatility[i]);
+	}
+}
+
+[[nodiscard]] const char* pricingStatusMessage(const PricingStatus status) noexcept
+{
+	switch (status)
+	{
+	case PricingStatus::Ok: return "Ok";
+	case PricingStatus::InvalidOptionType: return "[!] Invalid option type: must be Call or Put.";
+	case PricingStatus::NonPositiveTime: return "[!] Time must be positive";
+	case PricingStatus::NonPositiveVolatility: return "[!] Volatility must be positive";
+	case PricingStatus::NonPositivePrice: return "[!] Underlying and strike prices must be positive";
+	case PricingStatus::InvalidStrikes: return "[!] Strikes of the strategy are in the wrong order";
+	default: return "[!] Unknown pricing status";
+	}
+}
+
+namespace
+{
+	/*
+		@checkChain : statuses[i] of every contract of the chain, returns how many aren't Ok
+		-.Every check is a negated comparison (NaN fails it) and the first failing one is picked with selects, the loop has no
+		early exit and no branch on the data so it vectorizes like the kernels it guards
+	*/
+	[[nodiscard]] std::size_t checkChain(const OptionChain& chain, const bool check_volatility, PricingStatus* statuses) noexcept
+	{
+		std::size_t invalid{ 0 };
+		for (std::size_t i{ 0 }; i < chain.size; ++i)
 		{
-			const double theta_part1 = -(params.underlying_price * params.volatility * dividend_discount * normalPdf(d1)) / (2 * std::sqrt(params.time));
-			const double theta_part2 = params.option_type == OptionType::Call ?
-				-params.interest_rate * params.strike_price * discount * normalCdf(d2) + params.dividend_yield * params.underlying_price * dividend_discount * normalCdf(d1) :
-				params.interest_rate * params.strike_price * discount * normalCdf(-d2) - params.dividend_yield * params.underlying_price * dividend_discount * normalCdf(-d1);
-			
-			return theta_part1 + theta_part2;
+			const OptionType option_type = chain.option_type[i];
+			const bool positive_prices = chain.underlying_price[i] > 0.0 && chain.strike_price[i] > 0.0;
+			const bool positive_volatility = !check_volatility || chain.volatility[i] > 0.0;
+
+			PricingStatus status = PricingStatus::Ok;
+			status = positive_prices ? status : PricingStatus::NonPositivePrice;
+			status = positive_volatility ? status : PricingStatus::NonPositiveVolatility;
+			status = chain.time[i] > 0.0 ? status : PricingStatus::NonPositiveTime;
+			status = option_type == OptionType::Call || option_type == OptionType::Put ? status : PricingStatus::InvalidOptionType;
+
+			statuses[i] = status;
+			invalid += status != PricingStatus::Ok;
 		}
-		case Greeks::Vega :
+		return invalid;
+	}
+
+	// @maskInvalid : column[i] = NaN wherever statuses[i] isn't Ok, only run when checkChain found invalid contracts
+	void maskInvalid(double* column, const PricingStatus* statuses, const std::size_t size) noexcept
+	{
+		for (std::size_t i{ 0 }; i < size; ++i)
 		{
-			return params.underlying_price * dividend_discount * normalPdf(d1) * std::sqrt(params.time);
+			column[i] = statuses[i] == PricingStatus::Ok ? column[i] : std::numeric_limits<double>::quiet_NaN();
 		}
-		case Greeks::Rho :
+	}
+}
+
+[[nodiscard]] std::size_t FinancialCalculator::calculateBlackScholes(const OptionChain& chain, Price* prices, PricingStatus* statuses) const noexcept
+{
+	FC_METRICS_SCOPE(BlackScholesChain);
+	FC_METRICS_ITEMS(chain.size);
+
+	const std::size_t invalid = checkChain(chain, true, statuses);
+	priceChainBlackScholes(chain, prices);
+	if (invalid != 0) maskInvalid(prices, statuses, chain.size);
+	return invalid;
+}
+
+[[nodiscard]] std::size_t FinancialCalculator::calculateGreeks(const OptionChain& chain, const OptionGreeksChain& greeks, PricingStatus* statuses) const noexcept
+{
+	FC_METRICS_SCOPE(GreeksChain);
+	FC_METRICS_ITEMS(chain.size);
+
+	const std::size_t invalid = checkChain(chain, true, statuses);
+	priceChainGreeks(chain, greeks);
+	if (invalid != 0)
+	{
+		for (double* column : { greeks.price, greeks.delta, greeks.gamma, greeks.theta, greeks.vega, greeks.rho })
 		{
-			return params.option_type == OptionType::Call ?
-				params.strike_price * params.time * discount * normalCdf(d2) :
-				-params.strike_price * params.time * discount * normalCdf(-d2);
+			maskInvalid(column, statuses, chain.size);
 		}
-		default:
-			throw std::invalid_argument("[!] Invalid Greek specified");
 	}
+	return invalid;
+}
+
+[[nodiscard]] std::size_t FinancialCalculator::calculateImpliedVolatility(const OptionChain& chain, const Price* paid_prices, Volatility* volatilities,
+	PricingStatus* statuses) const noexcept
+{
+	FC_METRICS_SCOPE(ImpliedVolatility);
+	FC_METRICS_ITEMS(chain.size);
+
+	const std::size_t invalid = checkChain(chain, false, statuses);
+	for (std::size_t i{ 0 }; i < chain.size; ++i)
+	{
+		// The solver has data dependent iterations anyway, invalid contracts are simply skipped
+		volatilities[i] = statuses[i] == PricingStatus::Ok
+			? solveImpliedVolatility(paid_prices[i], chain.underlying_price[i], chain.strike_price[i], chain.time[i], chain.interest_rate[i], chain.option_type[i], chain.volatility[i])
+			: std::numeric_limits<double>::quiet_NaN();
+	}
+	return invalid;
 }
 
 /*
 	@calculateMonteCarlo: Gets the Monte Carlo pricing
 
 	-.Calculate the relation between one day and the time passed. For example 1 day represents 0.00274 of a year.
+	(With SimulationMode::TerminalOnly the whole life of the option is a single step, the GBM solution being exact for any step size)
 	-.The underlying asset price is modeled using GBM - dS = μS dt + σS dW
 		-. Where:
 			-.S is the asset price
@@ -81,7 +488,7 @@
 	-.Each day:
 		-. Box-Muller Transform will be calculated
 			-. Two random uniform variables u1 and u2 will be generated
-			-. Transforms them using the following formula Z = sqrt(-2 * ln(u1)) * cos(2π * u2)
+			-. Transforms them using the following formula Z1 = sqrt(-2 * ln(u1)) * cos(2π * u2) and Z2 = sqrt(-2 * ln(u1)) * sin(2π * u2)
 			-. This basically converts uniform randomness into normally distributed randomness. In an uniform distribution [0,1] all the 
 			values between 0 and 1 have the same chance of appearing, but with the normal distribution, where the values that are closer
 			to the mean have more chances of appearing. (the normal distribution is often used as an approximation or simplification when modeling stock)
@@ -90,139 +497,2292 @@
 			-. Drift: The drif basically represents the expected change in the asset's price over time
 			-. Diffusion: Attempts to model the fluctuations in the asset's price that are random
 			-. Exp is used in order to not get negative values for the underlying price
-	-.After each day:
+		-. The paths are simulated in blocks of MONTE_CARLO_BLOCK_SIZE, so every step draws the normals of the whole block in bulk
+		and applies one vectorized GBM update to all of its paths (see simd.h)
+	-.After each path:
 		-. Calculate the payoff and add it to the total payoff
 	-.After all the iterations:
 		-. Calculate the average payoff
 		-. Calculate the discount to get the present value of the option. Essentially we're adjusting a future payoff to its present-day equivalent,
 		considering what that money could earn if invested at the risk-free rate instead.
+	-.Multithreading:
+		-. The samples are split as evenly as possible across number_of_threads workers, each one owning its own random stream derived
+		from (seed, worker index), so a fixed seed and thread count always reproduce the same price.
+		-. The engine behind the streams is selected with random_engine (Mersenne Twister, xoshiro256++ or the counter-based Philox)
+		-. Every worker only accumulates its own payoff statistics, they are merged once all the workers are done.
 */
 [[nodiscard]] double FinancialCalculator::calculateMonteCarlo(const MonteCarloParams& params) const
 {
-	RandomGenerator<double> random_generator_uniform(0.0, 1.0);
-
-	Price total_payoff{ 0.0 };
-	Price underlying_price = params.underlying_price;
-
-	const std::size_t total_days = static_cast<std::size_t>(params.time * 365.0);
-	const double time_step = params.time / total_days;
+	return calculateMonteCarloEstimate(params).price;
+}
 
-	for (std::size_t i{ 0 }; i < params.number_of_simulations; ++i)
+namespace
+{
+	// Running statistic a path payoff keeps next to the price of every path
+	enum class PathStatistic
 	{
-		underlying_price = params.underlying_price; // Reset underlying price for each simulation
+		None,
+		Sum,		// Σ S(t) (Asian)
+		Maximum,	// max S(t), spot included (lookbacks)
+		Minimum,
+		CrossedAbove,	// 1 once S(t) >= barrier, 0 before (barriers)
+		CrossedBelow,	// 1 once S(t) <= barrier
+	};
 
-		for (std::size_t day{ 0 }; day < total_days; ++day)
+	[[nodiscard]] PathStatistic pathStatistic(const PathPayoff path_payoff, const OptionType option_type) noexcept
+	{
+		const bool call = option_type == OptionType::Call;
+		switch (path_payoff)
 		{
-			// Box-Muller Transform to generate standard normal random variable
-			const double u1 = random_generator_uniform.getRandomValue();
-			const double u2 = random_generator_uniform.getRandomValue();
-			const double random_normal = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * MATH_PI * u2);
+		case PathPayoff::Asian: return PathStatistic::Sum;
+		case PathPayoff::UpAndOut:
+		case PathPayoff::UpAndIn: return PathStatistic::CrossedAbove;
+		case PathPayoff::DownAndOut:
+		case PathPayoff::DownAndIn: return PathStatistic::CrossedBelow;
+		case PathPayoff::LookbackFixedStrike: return call ? PathStatistic::Maximum : PathStatistic::Minimum;
+		case PathPayoff::LookbackFloatingStrike: return call ? PathStatistic::Minimum : PathStatistic::Maximum;
+		default: return PathStatistic::None;
+		}
+	}
 
-			// Geometric Brownian Motion
-			const auto drift = (params.interest_rate - 0.5 * std::pow(params.volatility, 2)) * time_step;
-			const auto diffusion = params.volatility * std::sqrt(time_step) * random_normal;
+	[[nodiscard]] double initialPathStatistic(const PathStatistic path_statistic, const Price spot, const Price barrier) noexcept
+	{
+		switch (path_statistic)
+		{
+		case PathStatistic::Maximum:
+		case PathStatistic::Minimum: return spot;
+		case PathStatistic::CrossedAbove: return spot >= barrier ? 1.0 : 0.0;
+		case PathStatistic::CrossedBelow: return spot <= barrier ? 1.0 : 0.0;
+		default: return 0.0;
+		}
+	}
 
-			underlying_price *= std::exp(drift + diffusion);
+	// @updatePathStatistic : Folds the prices of one step into the statistics of the paths (branch-free lane loops)
+	void updatePathStatistic(const PathStatistic path_statistic, const Price* prices, double* statistics, const std::size_t size, const Price barrier) noexcept
+	{
+		switch (path_statistic)
+		{
+		case PathStatistic::Sum:
+			for (std::size_t i{ 0 }; i < size; ++i) statistics[i] += prices[i];
+			break;
+		case PathStatistic::Maximum:
+			for (std::size_t i{ 0 }; i < size; ++i) statistics[i] = std::max(statistics[i], prices[i]);
+			break;
+		case PathStatistic::Minimum:
+			for (std::size_t i{ 0 }; i < size; ++i) statistics[i] = std::min(statistics[i], prices[i]);
+			break;
+		case PathStatistic::CrossedAbove:
+			for (std::size_t i{ 0 }; i < size; ++i) statistics[i] = prices[i] >= barrier ? 1.0 : statistics[i];
+			break;
+		case PathStatistic::CrossedBelow:
+			for (std::size_t i{ 0 }; i < size; ++i) statistics[i] = prices[i] <= barrier ? 1.0 : statistics[i];
+			break;
+		default:
+			break;
 		}
+	}
 
-		Price payoff{ 0.0 };
-		if (params.option_type == OptionType::Call)
+	// @pathPayoff : Payoff of a path from its terminal price and running statistic
+	template<OptionType Type>
+	[[nodiscard]] Price pathPayoff(const PathPayoff path_payoff, const Price terminal_price, const double statistic, const Price strike_price, const std::size_t steps) noexcept
+	{
+		switch (path_payoff)
 		{
-			payoff = std::max(underlying_price - params.strike_price, 0.0);
+		case PathPayoff::Asian: return intrinsicValue<Type>(statistic / static_cast<double>(steps), strike_price);
+		case PathPayoff::UpAndOut:
+		case PathPayoff::DownAndOut: return statistic != 0.0 ? 0.0 : intrinsicValue<Type>(terminal_price, strike_price);
+		case PathPayoff::UpAndIn:
+		case PathPayoff::DownAndIn: return statistic != 0.0 ? intrinsicValue<Type>(terminal_price, strike_price) : 0.0;
+		case PathPayoff::LookbackFixedStrike: return intrinsicValue<Type>(statistic, strike_price);
+		case PathPayoff::LookbackFloatingStrike: return intrinsicValue<Type>(terminal_price, statistic);	// The extreme is the strike
+		default: return intrinsicValue<Type>(terminal_price, strike_price);
 		}
-		else if (params.option_type == OptionType::Put)
+	}
+
+	// @removeKnockedOut : Swaps the knocked-out paths (pairs when mirrored_statistics is set) past the live ones, returns how many are left
+	[[nodiscard]] std::size_t removeKnockedOut(Price* prices, double* statistics, Price* mirrored_prices, double* mirrored_statistics, std::size_t live) noexcept
+	{
+		std::size_t i{ 0 };
+		while (i < live)
 		{
-			payoff = std::max(params.strike_price - underlying_price, 0.0);
+			const bool out = statistics[i] != 0.0 && (mirrored_statistics == nullptr || mirrored_statistics[i] != 0.0);
+			if (!out)
+			{
+				++i;
+				continue;
+			}
+
+			--live;
+			prices[i] = prices[live];
+			statistics[i] = statistics[live];
+			if (mirrored_statistics != nullptr)
+			{
+				mirrored_prices[i] = mirrored_prices[live];
+				mirrored_statistics[i] = mirrored_statistics[live];
+			}
 		}
+		return live;
+	}
 
-		total_payoff += payoff;
+	// @anyAlive : True while a path (pair) of the block is not knocked out
+	[[nodiscard]] bool anyAlive(const double* statistics, const double* mirrored_statistics, const std::size_t size) noexcept
+	{
+		for (std::size_t i{ 0 }; i < size; ++i)
+		{
+			if (statistics[i] == 0.0 || (mirrored_statistics != nullptr && mirrored_statistics[i] == 0.0)) return true;
+		}
+		return false;
 	}
 
-	const auto average_payoff = total_payoff / params.number_of_simulations;
-	const auto discount_factor = std::exp(-params.interest_rate * params.time);
+	// Normals of the pseudo-random sampling: every step draws fresh uniforms for the whole block and transforms them with Box-Muller
+	template<typename Engine>
+	class PseudoRandomNormals
+	{
+	private:
+		RandomGenerator<double, Engine> random_generator_uniform_;
+		double* uniforms_;	// MONTE_CARLO_BLOCK_SIZE scratch elements each
+		double* normals_;
 
-	return average_payoff * discount_factor;
-}
+	public:
+		PseudoRandomNormals(const std::uint64_t seed, const std::uint64_t stream, double* scratch)
+			: random_generator_uniform_(0.0, 1.0, seed, stream), uniforms_(scratch), normals_(scratch + MONTE_CARLO_BLOCK_SIZE) {}
 
-[[nodiscard]] inline double normalCdf(double x) noexcept
-{
-	return 0.5 * std::erfc(-x / std::sqrt(2.0));
-}
+		static constexpr bool EXCHANGEABLE_PATHS = true;	// Every draw is independent, any normal can drive any path
 
-[[nodiscard]] inline double normalPdf(double x) noexcept
-{
-	return (1.0 / std::sqrt(2.0 * MATH_PI)) * std::exp(-0.5 * x * x);
-}
+		// @scratchSize : Doubles of scratch the source works in
+		[[nodiscard]] static constexpr std::size_t scratchSize() noexcept { return 2 * MONTE_CARLO_BLOCK_SIZE; }
 
-Option::Option(Price strike, Price premium, OptionType option_type) : strike_(strike), premium_(premium), option_type_(option_type) {};
+		void beginBlock(std::size_t /*block_size*/) noexcept {}
 
-// @calculatePayoff: Simply calculates the option's payoff at expiration or current value if exercised immediately, minus the premium paid
+		// @stepNormals : Normals of the first paths of the block for one step (only those are drawn)
+		[[nodiscard]] const double* stepNormals(std::size_t /*step*/, const std::size_t paths) noexcept
+		{
+			const std::size_t draws = paths + (paths & 1);	// Box-Muller produces normals in pairs
+			random_generator_uniform_.fillUniform(uniforms_, draws);
+			normalFromUniformBatch(uniforms_, normals_, draws);
+			return normals_;
+		}
+	};
 
-[[nodiscard]] inline double Option::calculatePayoff(Price spotPrice) const
-{
-	if (option_type_ == OptionType::Call)
+	// Normals of the quasi-random sampling: one Sobol point per path (a coordinate per step) is mapped to normals through the inverse CDF,
+	// the Brownian bridge turns them into the increments of the path and they are stored step-major so each step reads the block contiguously
+	class SobolNormals
 	{
-		return std::max(spotPrice - strike_, 0.0) - premium_;
-	}
-	
-	return std::max(strike_ - spotPrice, 0.0) - premium_;
-}
+	private:
+		SobolSequence& sequence_;	// Copy owned by the worker
+		const BrownianBridge& brownian_bridge_;
+		std::size_t dimensions_;
+		double* point_;
+		double* increments_;
+		double* normals_;
 
-// @getPutSpread: A put spread is buying a put option with a higher strike price and selling a put option with a lower strike price
-[[nodiscard]] inline StrategyPayoff CalculateStrategy::getPutSpread(const Option& long_put, const Option& short_put, Price spotPrice) const
-{
-	if (long_put.getStrike() <= short_put.getStrike())
-	{
-		throw std::runtime_error("[!] Long put strike should be higher than short put strike");
-	}
-	
-	return long_put.calculatePayoff(spotPrice) - short_put.calculatePayoff(spotPrice);
-}
+	public:
+		SobolNormals(SobolSequence& sequence, const BrownianBridge& brownian_bridge, const std::uint64_t first_index, double* scratch)
+			: sequence_(sequence), brownian_bridge_(brownian_bridge), dimensions_(sequence.dimensions()), point_(scratch), increments_(scratch + dimensions_),
+			normals_(scratch + 2 * dimensions_)
+		{
+			sequence_.seek(first_index);
+		}
 
-// @getCallSpread: A call spread is buying a put option with a lower strike price and selling a put option with a higher strike price
-[[nodiscard]] inline StrategyPayoff CalculateStrategy::getCallSpread(const Option& long_call, const Option& short_call, Price spotPrice) const
-{
-	if (long_call.getStrike() >= short_call.getStrike())
-	{
-		throw std::runtime_error("[!] Long call strike should be lower than short call strike");
-	}
-	
-	return long_call.calculatePayoff(spotPrice) - short_call.calculatePayoff(spotPrice);
-}
+		static constexpr bool EXCHANGEABLE_PATHS = false;	// The normals of a path are the coordinates of its own point
 
-/*
-	@getButterfly: A butterfly is:
-		1-. Buying a call option with a lower strike price (which is the wing1)
-		2-. Selling two call options with a middle strike price (which is the body)
-		3-. Finally buying a call option with a higher strike price (which is the wing2).
-*/
-[[nodiscard]] inline StrategyPayoff CalculateStrategy::getButterfly(const Option& wing1, const Option& body, const Option& wing2, Price spotPrice) const
-{
-	if (wing1.getStrike() >= body.getStrike() || body.getStrike() >= wing2.getStrike())
-	{
-		throw std::runtime_error("[!] Strikes should be in ascending order");
-	}
-	
-	return wing1.calculatePayoff(spotPrice) - 2.0 * body.calculatePayoff(spotPrice) + wing2.calculatePayoff(spotPrice);
-}
+		[[nodiscard]] static constexpr std::size_t scratchSize(const std::size_t dimensions) noexcept { return dimensions * (MONTE_CARLO_BLOCK_SIZE + 2); }
 
-// @getStrangle: A strangle is buying a put option with a lower strike price and buying a call option with a higher strike price.
-[[nodiscard]] inline StrategyPayoff CalculateStrategy::getStrangle(const Option& put, const Option& call, Price spotPrice) const
-{
-	if (put.getStrike() >= call.getStrike())
+		void beginBlock(const std::size_t block_size) noexcept
+		{
+			for (std::size_t path{ 0 }; path < block_size; ++path)
+			{
+				sequence_.next(point_);
+				for (std::size_t dimension{ 0 }; dimension < dimensions_; ++dimension)
+				{
+					point_[dimension] = inverseNormalCdf(point_[dimension]);
+				}
+				brownian_bridge_.buildIncrements(point_, increments_);
+
+				for (std::size_t step{ 0 }; step < dimensions_; ++step)
+				{
+					normals_[step * MONTE_CARLO_BLOCK_SIZE + path] = increments_[step];
+				}
+			}
+		}
+
+		[[nodiscard]] const double* stepNormals(const std::size_t step, std::size_t /*paths*/) const noexcept { return normals_ + step * MONTE_CARLO_BLOCK_SIZE; }
+	};
+
+	/*
+		@choleskyFactor: Lower-triangular L (row-major, assets x assets) with L Lᵀ = correlation, the identity for an empty matrix
+		-.Semi-definite matrices are accepted (perfectly correlated assets): a null pivot gives a null column, returns false once a
+		pivot is clearly negative (not a correlation matrix)
+	*/
+	[[nodiscard]] bool choleskyFactor(const std::vector<double>& correlation, const std::size_t assets, double* lower) noexcept
 	{
-		throw std::runtime_error("[!] Put strike should be lower than Call strike");
+		constexpr double PIVOT_TOLERANCE = 1e-12;
+
+		std::fill_n(lower, assets * assets, 0.0);
+		for (std::size_t row{ 0 }; row < assets; ++row)
+		{
+			for (std::size_t column{ 0 }; column <= row; ++column)
+			{
+				double value = correlation.empty() ? (row == column ? 1.0 : 0.0) : correlation[row * assets + column];
+				for (std::size_t k{ 0 }; k < column; ++k)
+				{
+					value -= lower[row * assets + k] * lower[column * assets + k];
+				}
+
+				if (row == column)
+				{
+					if (value < -PIVOT_TOLERANCE) return false;
+					lower[row * assets + row] = std::sqrt(std::max(value, 0.0));
+				}
+				else
+				{
+					const double pivot = lower[column * assets + column];
+					lower[row * assets + column] = pivot > 0.0 ? value / pivot : 0.0;
+				}
+			}
+		}
+		return true;
 	}
-	
-	return put.calculatePayoff(spotPrice) + call.calculatePayoff(spotPrice);
-}
 
-// @getStraddle : A straddle is buying a put option and a call option with the same strike price
-[[nodiscard]] inline StrategyPayoff CalculateStrategy::getStraddle(const Option& put, const Option& call, Price spotPrice) const
-{
-	if (put.getStrike() != call.getStrike()) 
+	/*
+		Correlated GBMs of the multi-asset mode over one block of paths, stored asset-major: row a of every matrix holds asset a for the
+		MONTE_CARLO_BLOCK_SIZE paths of the block, so a step is one lower-triangular product W = L Z over contiguous rows and one
+		vectorized GBM update per asset, then the basket values Σ w_a S_a are folded from the rows
+	*/
+	class BasketPaths
 	{
-		throw std::runtime_error("For Straddle, Put and Call strikes should be the same");
-	}
-	return put.calculatePayoff(spotPrice) + call.calculatePayoff(spotPrice);
+	private:
+		const std::vector<BasketAsset>& assets_;
+		std::size_t count_;
+		double* cholesky_;		// count_ x count_
+		double* drift_;			// (r - σ_a²/2)Δt
+		double* diffusion_scale_;	// σ_a√Δt
+		double* prices_;		// count_ x MONTE_CARLO_BLOCK_SIZE
+		double* mirrored_prices_;
+		double* normals_;
+
+	public:
+		BasketPaths(const MonteCarloParams& params, const double time_step, double* scratch) noexcept
+			: assets_(params.assets), count_(params.assets.size()), cholesky_(scratch), drift_(cholesky_ + count_ * count_), diffusion_scale_(drift_ + count_),
+			prices_(diffusion_scale_ + count_), mirrored_prices_(prices_ + count_ * MONTE_CARLO_BLOCK_SIZE), normals_(mirrored_prices_ + count_ * MONTE_CARLO_BLOCK_SIZE)
+		{
+			static_cast<void>(choleskyFactor(params.correlation, count_, cholesky_));	// Validated by planMonteCarlo
+			for (std::size_t a{ 0 }; a < count_; ++a)
+			{
+				drift_[a] = (params.interest_rate - 0.5 * assets_[a].volatility * assets_[a].volatility) * time_step;
+				diffusion_scale_[a] = assets_[a].volatility * std::sqrt(time_step);
+			}
+		}
+
+		// @scratchSize : Doubles of scratch for a basket of assets
+		[[nodiscard]] static constexpr std::size_t scratchSize(const std::size_t assets) noexcept { return assets * (assets + 2) + 3 * assets * MONTE_CARLO_BLOCK_SIZE; }
+
+		// @initialValue : Basket value at the spots
+		[[nodiscard]] Price initialValue() const noexcept
+		{
+			Price value{ 0.0 };
+			for (const BasketAsset& asset : assets_) value += asset.weight * asset.underlying_price;
+			return value;
+		}
+
+		void beginBlock(const std::size_t block_size, const bool antithetic) noexcept
+		{
+			for (std::size_t a{ 0 }; a < count_; ++a)
+			{
+				std::fill_n(prices_ + a * MONTE_CARLO_BLOCK_SIZE, block_size, assets_[a].underlying_price);
+				std::fill_n(mirrored_prices_ + a * MONTE_CARLO_BLOCK_SIZE, antithetic ? block_size : 0, assets_[a].underlying_price);
+			}
+		}
+
+		// @step : Moves the first paths of the block by one step and writes their basket values (and the mirrored ones when antithetic)
+		template<typename NormalSource>
+		void step(NormalSource& normal_source, const std::size_t step, const std::size_t paths, const bool antithetic, Price* basket, Price* mirrored_basket) noexcept
+		{
+			// Independent normals, one draw of the source per asset
+			for (std::size_t a{ 0 }; a < count_; ++a)
+			{
+				const double* normals = normal_source.stepNormals(step, paths);
+				std::copy_n(normals, paths, normals_ + a * MONTE_CARLO_BLOCK_SIZE);
+			}
+
+			// W = L Z in place, from the last row up: row a only reads the rows b < a, which still hold Z
+			for (std::size_t a{ count_ }; a-- > 0;)
+			{
+				double* const row = normals_ + a * MONTE_CARLO_BLOCK_SIZE;
+				const double diagonal = cholesky_[a * count_ + a];
+				for (std::size_t i{ 0 }; i < paths; ++i) row[i] *= diagonal;
+
+				for (std::size_t b{ 0 }; b < a; ++b)
+				{
+					const double factor = cholesky_[a * count_ + b];
+					const double* const source = normals_ + b * MONTE_CARLO_BLOCK_SIZE;
+					for (std::size_t i{ 0 }; i < paths; ++i) row[i] += factor * source[i];
+				}
+			}
+
+			std::fill_n(basket, paths, 0.0);
+			std::fill_n(mirrored_basket, antithetic ? paths : 0, 0.0);
+			for (std::size_t a{ 0 }; a < count_; ++a)
+			{
+				const double weight = assets_[a].weight;
+				const double* const normals = normals_ + a * MONTE_CARLO_BLOCK_SIZE;
+				Price* const prices = prices_ + a * MONTE_CARLO_BLOCK_SIZE;
+
+				gbmStepBatch(prices, normals, paths, drift_[a], diffusion_scale_[a]);
+				for (std::size_t i{ 0 }; i < paths; ++i) basket[i] += weight * prices[i];
+
+				if (antithetic)
+				{
+					Price* const mirrored_prices = mirrored_prices_ + a * MONTE_CARLO_BLOCK_SIZE;
+					gbmStepBatch(mirrored_prices, normals, paths, drift_[a], -diffusion_scale_[a]);
+					for (std::size_t i{ 0 }; i < paths; ++i) mirrored_basket[i] += weight * mirrored_prices[i];
+				}
+			}
+		}
+	};
+
+	// Undiscounted estimate of the mean payoff with the variance of a single sample
+	struct PayoffEstimate
+	{
+		double mean{};
+		double variance{};
+	};
+
+	// @estimatePayoff : Mean and variance of the sample payoffs, adjusted by the control (of known mean control_expected) when requested
+	[[nodiscard]] PayoffEstimate estimatePayoff(const PayoffStatistics& statistics, const MonteCarloParams& params, const double control_expected) noexcept
+	{
+		const auto samples = static_cast<double>(statistics.samples);
+
+		PayoffEstimate estimate;
+		estimate.mean = statistics.sum / samples;
+		estimate.variance = samples > 1 ? (statistics.sum_squares - samples * estimate.mean * estimate.mean) / (samples - 1) : 0.0;
+
+		if (params.variance_reduction == VarianceReduction::ControlVariate && samples > 1)
+		{
+			const double control_mean = statistics.control_sum / samples;
+			const double control_variance = (statistics.control_sum_squares - samples * control_mean * control_mean) / (samples - 1);
+			const double covariance = (statistics.cross_sum - samples * control_mean * estimate.mean) / (samples - 1);
+			const double beta = control_variance > 0.0 ? covariance / control_variance : 0.0;
+
+			estimate.mean -= beta * (control_mean - control_expected);
+			estimate.variance -= beta * covariance;
+		}
+
+		estimate.variance = std::max(estimate.variance, 0.0);
+		return estimate;
+	}
+
+	// Everything a Monte Carlo call derives from its parameters before simulating
+	struct MonteCarloPlan
+	{
+		std::uint64_t seed{};
+		bool antithetic{};
+		std::size_t number_of_samples{};	// Paths, or antithetic pairs
+		double discount_factor{};
+		double control_expected{};		// Undiscounted E[X] of the control variate
+		std::size_t replicates{ 1 };		// Quasi-random sampling only
+		std::size_t samples_per_replicate{};
+		bool progressive{};			// Stops on a target standard error or a time budget
+	};
+
+	// @planMonteCarlo : Validates the parameters and derives the plan shared by the synchronous and submitted pricers
+	[[nodiscard]] MonteCarloPlan planMonteCarlo(const FinancialCalculator& calculator, const MonteCarloParams& params)
+	{
+		if (params.option_type != OptionType::Call && params.option_type != OptionType::Put) throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+		if (params.path_payoff != PathPayoff::European && params.simulation_mode != SimulationMode::DailySteps)
+		{
+			throw std::invalid_argument("[!] Path-dependent payoffs need SimulationMode::DailySteps");
+		}
+		const PathStatistic path_statistic = pathStatistic(params.path_payoff, params.option_type);
+		if ((path_statistic == PathStatistic::CrossedAbove || path_statistic == PathStatistic::CrossedBelow) && !(params.barrier > 0))
+		{
+			throw std::invalid_argument("[!] The barrier must be positive");
+		}
+
+		if (!(params.target_standard_error >= 0) || !(params.time_budget >= 0))
+		{
+			throw std::invalid_argument("[!] The target standard error and the time budget can't be negative");
+		}
+		if (params.number_of_simulations == 0 && params.target_standard_error == 0 && params.time_budget == 0)
+		{
+			throw std::invalid_argument("[!] The number of simulations must be positive (0 means no limit only in progressive mode)");
+		}
+		if (params.target_standard_error > 0 && params.sampling_method == SamplingMethod::Sobol)
+		{
+			throw std::invalid_argument("[!] Plain Sobol sampling has no error estimate, a target standard error needs PseudoRandom or RandomizedSobol");
+		}
+
+		if (!params.assets.empty())
+		{
+			const std::size_t assets = params.assets.size();
+			if (params.sampling_method != SamplingMethod::PseudoRandom || params.variance_reduction == VarianceReduction::ControlVariate)
+			{
+				throw std::invalid_argument("[!] Multi-asset Monte Carlo needs pseudo-random sampling without control variate");
+			}
+			for (const BasketAsset& asset : params.assets)
+			{
+				if (!(asset.underlying_price > 0) || !(asset.volatility > 0)) throw std::invalid_argument("[!] Basket assets need positive prices and volatilities");
+			}
+			if (!params.correlation.empty())
+			{
+				if (params.correlation.size() != assets * assets) throw std::invalid_argument("[!] The correlation matrix must be assets x assets");
+				for (std::size_t row{ 0 }; row < assets; ++row)
+				{
+					if (params.correlation[row * assets + row] != 1.0) throw std::invalid_argument("[!] The correlation matrix must have a unit diagonal");
+					for (std::size_t column{ 0 }; column < row; ++column)
+					{
+						const double correlation = params.correlation[row * assets + column];
+						if (correlation != params.correlation[column * assets + row] || !(std::abs(correlation) <= 1.0))
+						{
+							throw std::invalid_argument("[!] The correlation matrix must be symmetric with entries in [-1, 1]");
+						}
+					}
+				}
+			}
+			std::vector<double> lower(assets * assets);
+			if (!choleskyFactor(params.correlation, assets, lower.data())) throw std::invalid_argument("[!] The correlation matrix is not positive semi-definite");
+		}
+
+		MonteCarloPlan plan;
+		plan.progressive = params.target_standard_error > 0 || params.time_budget > 0;
+		plan.seed = params.seed != 0 ? params.seed : freshSeed();
+		plan.antithetic = params.variance_reduction == VarianceReduction::Antithetic;
+		plan.number_of_samples = plan.antithetic ? (params.number_of_simulations + 1) / 2 : params.number_of_simulations;
+		plan.discount_factor = std::exp(-params.interest_rate * params.time);
+
+		if (params.variance_reduction == VarianceReduction::ControlVariate && params.path_payoff == PathPayoff::European)
+		{
+			plan.control_expected = params.underlying_price / plan.discount_factor;	// E[S_T] = S_0 * e^(rT)
+		}
+		else if (params.variance_reduction == VarianceReduction::ControlVariate)
+		{
+			const BlackScholesParams control_params{ params.interest_rate, params.underlying_price, params.strike_price, params.time, params.volatility, params.option_type, params.paid_price };
+			plan.control_expected = calculator.calculateBlackScholes(control_params) / plan.discount_factor;
+		}
+
+		if (params.sampling_method == SamplingMethod::RandomizedSobol)
+		{
+			if (params.qmc_replicates == 0) throw std::invalid_argument("[!] Randomized Sobol sampling needs at least one replicate");
+			plan.replicates = params.qmc_replicates;
+		}
+		plan.samples_per_replicate = (plan.number_of_samples + plan.replicates - 1) / plan.replicates;
+
+		return plan;
+	}
+
+	// @pseudoRandomResult : Discounted price and standard error of the merged pseudo-random statistics
+	[[nodiscard]] MonteCarloResult pseudoRandomResult(const PayoffStatistics& statistics, const MonteCarloParams& params, const MonteCarloPlan& plan) noexcept
+	{
+		const PayoffEstimate estimate = estimatePayoff(statistics, params, plan.control_expected);
+
+		MonteCarloResult result;
+		result.price = estimate.mean * plan.discount_factor;
+		result.standard_error = std::sqrt(estimate.variance / static_cast<double>(statistics.samples)) * plan.discount_factor;
+		result.number_of_paths = plan.antithetic ? 2 * statistics.samples : statistics.samples;
+		return result;
+	}
+
+	// @replicatesResult : Discounted mean of the quasi-random replicate estimates, the standard error is the one of their mean
+	[[nodiscard]] MonteCarloResult replicatesResult(const double sum_estimates, const double sum_squared_estimates, const MonteCarloPlan& plan) noexcept
+	{
+		const auto count = static_cast<double>(plan.replicates);
+		const double mean = sum_estimates / count;
+		const double variance = plan.replicates > 1 ? std::max((sum_squared_estimates - count * mean * mean) / (count - 1), 0.0) : 0.0;
+
+		MonteCarloResult result;
+		result.price = mean * plan.discount_factor;
+		result.standard_error = plan.replicates > 1 ? std::sqrt(variance / count) * plan.discount_factor : std::numeric_limits<double>::quiet_NaN();
+		result.number_of_paths = plan.replicates * plan.samples_per_replicate * (plan.antithetic ? 2 : 1);
+		return result;
+	}
+
+	// Samples per replicate before the target standard error can end a progressive run, and before a null standard error counts
+	// (every payoff equal so far, e.g. a deep out of the money contract) rather than asking for more paths
+	constexpr std::size_t PROGRESSIVE_MIN_SAMPLES = 16 * MONTE_CARLO_TASK_SAMPLES;
+	constexpr std::size_t PROGRESSIVE_DEGENERATE_SAMPLES = 256 * MONTE_CARLO_TASK_SAMPLES;
+
+	/*
+		@ProgressiveRun: Progressive Monte Carlo, rounds of MONTE_CARLO_TASK_SAMPLES sample chunks until the target standard error,
+		the path limit or the time budget is reached
+		-.Chunk c of a replicate always holds the same samples (stream c / Sobol indices from 1 + c * MONTE_CARLO_TASK_SAMPLES), so the
+		estimate after n chunks depends neither on the round sizes nor on the thread count, and a run up to the path limit gives
+		the estimate of submitMonteCarlo
+		-.The first round runs one chunk per worker, the next ones are sized from the error so far (it falls as 1 / √paths) for the paths
+		the target still needs, at most doubling the paths already simulated and bounded by the time left at the pace of the previous rounds
+		-.The target only ends the run after PROGRESSIVE_MIN_SAMPLES samples per replicate with a positive standard error (a null one
+		is only trusted after PROGRESSIVE_DEGENERATE_SAMPLES samples)
+		-.With a control (asynchronous requests) the time left is also bounded by its deadline, and endRound checks it: a cancelled
+		request, or one reaching its deadline before it is done, throws PricingCancelled between two rounds
+		-.The caller simulates the chunks [firstChunk(), firstChunk() + roundChunks()) of every replicate into roundStatistics()
+		(replicate-major, no chunk going past sampleLimit() samples per replicate) between beginRound and endRound
+	*/
+	class ProgressiveRun
+	{
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		const MonteCarloParams& params_;
+		MonteCarloPlan plan_;
+		const PricingControl* control_;
+		Clock::time_point start_;
+		std::size_t sample_limit_;
+		std::size_t chunk_limit_;
+		std::size_t granularity_;	// Chunks per replicate keeping every worker busy
+		std::pmr::vector<PayoffStatistics> replicate_statistics_;
+		std::pmr::vector<PayoffStatistics> round_statistics_;
+		std::size_t chunks_{ 0 };
+		std::size_t round_;
+		std::size_t round_chunks_{ 0 };
+		MonteCarloResult result_{};
+
+		// @timeLeft : Seconds of budget left (the deadline of the control included), infinity without any bound
+		[[nodiscard]] double timeLeft(const double elapsed) const noexcept
+		{
+			double left = params_.time_budget > 0 ? params_.time_budget - elapsed : std::numeric_limits<double>::infinity();
+			if (control_ != nullptr && control_->deadline() != PricingControl::Clock::time_point::max())
+			{
+				left = std::min(left, std::chrono::duration<double>(control_->deadline() - PricingControl::Clock::now()).count());
+			}
+			return left;
+		}
+
+	public:
+		ProgressiveRun(const MonteCarloParams& params, const MonteCarloPlan& plan, const std::size_t workers, const PricingControl* control, std::pmr::memory_resource* resource)
+			: params_(params), plan_(plan), control_(control), start_(Clock::now()),
+			sample_limit_(params.number_of_simulations != 0 ? plan.samples_per_replicate : std::numeric_limits<std::size_t>::max()),
+			chunk_limit_(std::max<std::size_t>(1, sample_limit_ / MONTE_CARLO_TASK_SAMPLES + (sample_limit_ % MONTE_CARLO_TASK_SAMPLES != 0 ? 1 : 0))),
+			granularity_((std::max<std::size_t>(1, workers) + plan.replicates - 1) / plan.replicates), replicate_statistics_(plan.replicates, resource),
+			round_statistics_(resource), round_(granularity_) {}
+
+		[[nodiscard]] inline std::size_t firstChunk() const noexcept { return chunks_; }
+		[[nodiscard]] inline std::size_t roundChunks() const noexcept { return round_chunks_; }
+		[[nodiscard]] inline std::size_t sampleLimit() const noexcept { return sample_limit_; }
+		[[nodiscard]] inline std::size_t replicates() const noexcept { return plan_.replicates; }
+		[[nodiscard]] inline PayoffStatistics* roundStatistics() noexcept { return round_statistics_.data(); }
+		[[nodiscard]] inline const MonteCarloResult& result() const noexcept { return result_; }
+
+		void beginRound()
+		{
+			round_chunks_ = std::min(round_, chunk_limit_ - chunks_);
+			round_statistics_.assign(plan_.replicates * round_chunks_, PayoffStatistics{});
+		}
+
+		// @endRound : Folds the round into the estimate, true once the run is done (result() is then final)
+		[[nodiscard]] bool endRound()
+		{
+			for (std::size_t replicate{ 0 }; replicate < plan_.replicates; ++replicate)
+			{
+				for (std::size_t chunk{ 0 }; chunk < round_chunks_; ++chunk)
+				{
+					replicate_statistics_[replicate] += round_statistics_[replicate * round_chunks_ + chunk];
+				}
+			}
+			chunks_ += round_chunks_;
+
+			if (params_.sampling_method == SamplingMethod::PseudoRandom)
+			{
+				result_ = pseudoRandomResult(replicate_statistics_.front(), params_, plan_);
+			}
+			else
+			{
+				double sum_estimates{ 0.0 };
+				double sum_squared_estimates{ 0.0 };
+				for (const auto& statistics : replicate_statistics_)
+				{
+					const double estimate = estimatePayoff(statistics, params_, plan_.control_expected).mean;
+					sum_estimates += estimate;
+					sum_squared_estimates += estimate * estimate;
+				}
+				plan_.samples_per_replicate = replicate_statistics_.front().samples;
+				result_ = replicatesResult(sum_estimates, sum_squared_estimates, plan_);
+			}
+
+			const std::size_t samples = replicate_statistics_.front().samples;
+			if (params_.target_standard_error > 0 && result_.standard_error <= params_.target_standard_error && samples >= PROGRESSIVE_MIN_SAMPLES
+				&& (result_.standard_error > 0 || samples >= PROGRESSIVE_DEGENERATE_SAMPLES))
+			{
+				result_.target_reached = true;
+				return true;
+			}
+			if (chunks_ == chunk_limit_) return true;
+
+			const double elapsed = std::chrono::duration<double>(Clock::now() - start_).count();
+			if (params_.time_budget > 0 && elapsed >= params_.time_budget) return true;
+			if (control_ != nullptr) control_->check();
+
+			std::size_t next = chunks_;
+			if (params_.target_standard_error > 0 && std::isfinite(result_.standard_error) && result_.standard_error > 0)
+			{
+				const double ratio = result_.standard_error / params_.target_standard_error;
+				next = std::min(next, static_cast<std::size_t>(std::ceil(static_cast<double>(chunks_) * (ratio * ratio - 1.0))));
+			}
+			const double time_left = timeLeft(elapsed);
+			if (std::isfinite(time_left))
+			{
+				const double chunks_left = std::max(time_left, 0.0) * static_cast<double>(chunks_) / std::max(elapsed, 1e-9);
+				next = std::min(next, static_cast<std::size_t>(std::min(chunks_left, static_cast<double>(chunk_limit_))));
+			}
+			round_ = std::max(granularity_, (next + granularity_ - 1) / granularity_ * granularity_);
+			return false;
+		}
+	};
+
+	// @progressiveEstimate : Runs a ProgressiveRun to the end, simulate_chunks(first_chunk, chunks, sample_limit, statistics) simulates every round
+	template<typename SimulateChunks>
+	[[nodiscard]] MonteCarloResult progressiveEstimate(const MonteCarloParams& params, const MonteCarloPlan& plan, const std::size_t workers, std::pmr::memory_resource* resource,
+		SimulateChunks&& simulate_chunks)
+	{
+		ProgressiveRun run(params, plan, workers, nullptr, resource);
+		do
+		{
+			run.beginRound();
+			simulate_chunks(run.firstChunk(), run.roundChunks(), run.sampleLimit(), run.roundStatistics());
+		} while (!run.endRound());
+
+		return run.result();
+	}
+
+	// @sourceScratchSize : Doubles of scratch of the normal source of simulateSamples
+	[[nodiscard]] std::size_t sourceScratchSize(const SobolSequence* sobol_sequence) noexcept
+	{
+		return sobol_sequence != nullptr ? SobolNormals::scratchSize(sobol_sequence->dimensions()) : PseudoRandomNormals<Philox4x32>::scratchSize();
+	}
+
+	// @sampleScratchSize : Doubles of scratch a call to simulateSamples needs, the buffers of its normal source, the block of simulatePayoffs then the basket paths
+	[[nodiscard]] std::size_t sampleScratchSize(const MonteCarloParams& params, const SobolSequence* sobol_sequence) noexcept
+	{
+		return sourceScratchSize(sobol_sequence) + 4 * MONTE_CARLO_BLOCK_SIZE + (params.assets.empty() ? 0 : BasketPaths::scratchSize(params.assets.size()));
+	}
+}
+
+/*
+	@calculateMonteCarloEstimate: Monte Carlo price together with its standard error
+	-.Antithetic: The samples are pairs of paths driven by Z and -Z, the payoff of a sample is the average of the pair. Both halves are
+	negatively correlated, so the variance of their average is lower than the one of two independent paths.
+	-.ControlVariate: Next to the payoff Y a control X of the same path with an exact mean E[X] is recorded. The estimator is
+	mean(Y) - β * (mean(X) - E[X]) with β = cov(X, Y) / var(X), which removes the part of the variance explained by X
+	(var = var(Y) - cov(X, Y)² / var(X)).
+		-. European payoffs: X is the terminal price S_T, E[X] = S_0 * e^(rT) (the European payoff itself would collapse the estimate
+		onto the closed form price with a null standard error)
+		-. Path-dependent payoffs (Asian, barriers, lookbacks): X is the European payoff of the path, E[X] comes from calculateBlackScholes
+	-.Standard error: sqrt(var / samples) of the (adjusted) sample payoffs, discounted like the price
+	-.Quasi-Monte Carlo (Sobol / RandomizedSobol): The normals of a path are the coordinates of one Sobol point (one dimension per step)
+	pushed through the inverse normal CDF and a Brownian bridge, so the first, best distributed, coordinates fix the terminal value
+	and the coarse shape of the path.
+		-. The points are not independent, so the sample variance says nothing about the error: plain Sobol reports NaN
+		-. RandomizedSobol prices qmc_replicates independent digital shifts of the point set, the standard error is the one of the
+		mean of the replicate estimates
+	-.Progressive (target_standard_error / time_budget set): number_of_simulations only caps the paths, they are simulated in rounds
+	until the standard error reaches the target or the budget is spent (see progressiveEstimate)
+*/
+[[nodiscard]] MonteCarloResult FinancialCalculator::calculateMonteCarloEstimate(const MonteCarloParams& params) const
+{
+	FC_METRICS_SCOPE(MonteCarlo);
+
+	const MonteCarloPlan plan = planMonteCarlo(*this, params);
+
+	if (plan.progressive)
+	{
+		const std::size_t number_of_threads = params.number_of_threads != 0 ? params.number_of_threads : std::max(1u, std::thread::hardware_concurrency());
+		const std::size_t steps = params.sampling_method != SamplingMethod::PseudoRandom ? monteCarloSteps(params) : 0;
+
+		std::pmr::memory_resource* resource = getScratchResource();
+		std::pmr::vector<SobolSequence> sobol_sequence(resource);
+		std::pmr::vector<BrownianBridge> brownian_bridge(resource);
+		if (steps != 0)
+		{
+			sobol_sequence.emplace_back(steps, resource);
+			brownian_bridge.emplace_back(steps, resource);
+		}
+
+		const MonteCarloResult result = progressiveEstimate(params, plan, number_of_threads, resource,
+			[&](const std::size_t first_chunk, const std::size_t chunks, const std::size_t sample_limit, PayoffStatistics* statistics)
+			{
+				runMonteCarloChunks(params, plan.seed, first_chunk, chunks, sample_limit, plan.replicates, number_of_threads, sobol_sequence.empty() ? nullptr : sobol_sequence.data(),
+					brownian_bridge.empty() ? nullptr : brownian_bridge.data(), statistics);
+			});
+		FC_METRICS_ITEMS(result.number_of_paths);
+		return result;
+	}
+
+	PayoffStatistics device_statistics;
+	if (compute_backend_ == ComputeBackend::Gpu && gpuSupportsMonteCarlo(params) && gpuSimulatePayoffs(params, plan.number_of_samples, plan.seed, device_statistics))
+	{
+		const MonteCarloResult result = pseudoRandomResult(device_statistics, params, plan);
+		FC_METRICS_ITEMS(result.number_of_paths);
+		return result;
+	}
+
+	if (params.sampling_method == SamplingMethod::PseudoRandom)
+	{
+		const MonteCarloResult result = pseudoRandomResult(runMonteCarloWorkers(params, plan.number_of_samples, plan.seed, nullptr, nullptr), params, plan);
+		FC_METRICS_ITEMS(result.number_of_paths);
+		return result;
+	}
+
+	const std::size_t steps = monteCarloSteps(params);
+	SobolSequence sobol_sequence(steps, getScratchResource());
+	const BrownianBridge brownian_bridge(steps, getScratchResource());
+
+	double sum_estimates{ 0.0 };
+	double sum_squared_estimates{ 0.0 };
+	for (std::size_t replicate{ 0 }; replicate < plan.replicates; ++replicate)
+	{
+		if (params.sampling_method == SamplingMethod::RandomizedSobol)
+		{
+			sobol_sequence.setDigitalShift(splitMix64(plan.seed + replicate));
+		}
+
+		const PayoffStatistics statistics = runMonteCarloWorkers(params, plan.samples_per_replicate, plan.seed, &sobol_sequence, &brownian_bridge);
+		const double estimate = estimatePayoff(statistics, params, plan.control_expected).mean;
+
+		sum_estimates += estimate;
+		sum_squared_estimates += estimate * estimate;
+	}
+
+	const MonteCarloResult result = replicatesResult(sum_estimates, sum_squared_estimates, plan);
+	FC_METRICS_ITEMS(result.number_of_paths);
+	return result;
+}
+
+/*
+	@runMonteCarloWorkers: Splits number_of_samples across the worker threads and merges their payoff statistics
+	-.Pseudo-random: worker w draws from stream w of seed with the selected engine
+	-.Sobol: worker w takes the next contiguous range of point indices (index 0, the origin, is skipped)
+*/
+[[nodiscard]] PayoffStatistics FinancialCalculator::runMonteCarloWorkers(const MonteCarloParams& params, const std::size_t number_of_samples, const std::uint64_t seed,
+	const SobolSequence* sobol_sequence, const BrownianBridge* brownian_bridge) const
+{
+	std::size_t number_of_threads = params.number_of_threads != 0 ? params.number_of_threads : std::max(1u, std::thread::hardware_concurrency());
+	number_of_threads = std::max<std::size_t>(1, std::min(number_of_threads, number_of_samples));
+
+	// Every allocation happens here on the calling thread, the resource doesn't have to be thread safe for the workers
+	std::pmr::memory_resource* resource = getScratchResource();
+	std::pmr::vector<PayoffStatistics> partial_statistics(number_of_threads, resource);
+
+	// One slice of scratch per worker: the buffers of its normal source, then the path prices and statistics of simulatePayoffs
+	const std::size_t worker_scratch = sampleScratchSize(params, sobol_sequence);
+	std::pmr::vector<double> scratch(number_of_threads * worker_scratch, resource);
+
+	std::pmr::vector<std::thread> workers(resource);
+	workers.reserve(number_of_threads - 1);
+
+	std::pmr::vector<SobolSequence> worker_sequences(resource);
+	if (sobol_sequence != nullptr)
+	{
+		worker_sequences.reserve(number_of_threads);
+		for (std::size_t worker{ 0 }; worker < number_of_threads; ++worker)
+		{
+			worker_sequences.emplace_back(*sobol_sequence, resource);
+		}
+	}
+
+	const auto run_worker = [&](const std::size_t worker)
+	{
+		const std::size_t base = number_of_samples / number_of_threads;
+		const std::size_t remainder = number_of_samples % number_of_threads;
+		const std::size_t samples = base + (worker < remainder ? 1 : 0);
+
+		SobolSequence* const sequence = sobol_sequence != nullptr ? &worker_sequences[worker] : nullptr;
+		partial_statistics[worker] = simulateSamples(params, samples, seed, worker, sequence, 1 + worker * base + std::min(worker, remainder), brownian_bridge,
+			scratch.data() + worker * worker_scratch);
+	};
+
+	for (std::size_t worker{ 1 }; worker < number_of_threads; ++worker)
+	{
+		workers.emplace_back(run_worker, worker);
+	}
+	run_worker(0); // The calling thread takes the first share instead of idling
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	// Destroyed from the back so a scratch arena gets the tables back in reverse allocation order
+	while (!worker_sequences.empty())
+	{
+		worker_sequences.pop_back();
+	}
+
+	PayoffStatistics statistics;
+	for (const auto& partial : partial_statistics)
+	{
+		statistics += partial;
+	}
+
+	return statistics;
+}
+
+/*
+	@runMonteCarloChunks: Simulates the chunks [first_chunk, first_chunk + chunks) of every replicate on number_of_threads threads
+	-.Chunk c holds the samples [c * MONTE_CARLO_TASK_SAMPLES, (c + 1) * MONTE_CARLO_TASK_SAMPLES) of its replicate (cut at sample_limit),
+	drawn from stream c of seed or from the points of sobol_sequence (unshifted) under the digital shift of the replicate
+	-.statistics receives the statistics of every chunk, replicate-major, worker w simulates the chunks w, w + number_of_threads...
+	-.Like runMonteCarloWorkers every allocation happens on the calling thread
+*/
+void FinancialCalculator::runMonteCarloChunks(const MonteCarloParams& params, const std::uint64_t seed, const std::size_t first_chunk, const std::size_t chunks,
+	const std::size_t sample_limit, const std::size_t replicates, std::size_t number_of_threads, const SobolSequence* sobol_sequence, const BrownianBridge* brownian_bridge,
+	PayoffStatistics* statistics) const
+{
+	const std::size_t tasks = replicates * chunks;
+	number_of_threads = std::max<std::size_t>(1, std::min(number_of_threads, tasks));
+
+	std::pmr::memory_resource* resource = getScratchResource();
+	const std::size_t worker_scratch = sampleScratchSize(params, sobol_sequence);
+	std::pmr::vector<double> scratch(number_of_threads * worker_scratch, resource);
+
+	std::pmr::vector<std::thread> workers(resource);
+	workers.reserve(number_of_threads - 1);
+
+	std::pmr::vector<SobolSequence> worker_sequences(resource);
+	if (sobol_sequence != nullptr)
+	{
+		worker_sequences.reserve(number_of_threads);
+		for (std::size_t worker{ 0 }; worker < number_of_threads; ++worker)
+		{
+			worker_sequences.emplace_back(*sobol_sequence, resource);
+		}
+	}
+
+	const auto run_worker = [&](const std::size_t worker)
+	{
+		for (std::size_t task{ worker }; task < tasks; task += number_of_threads)
+		{
+			const std::size_t replicate = task / chunks;
+			const std::size_t chunk = first_chunk + task % chunks;
+			const std::size_t first = chunk * MONTE_CARLO_TASK_SAMPLES;
+			const std::size_t samples = std::min(MONTE_CARLO_TASK_SAMPLES, sample_limit - std::min(first, sample_limit));
+
+			SobolSequence* sequence{ nullptr };
+			if (sobol_sequence != nullptr)
+			{
+				sequence = &worker_sequences[worker];
+				sequence->setDigitalShift(params.sampling_method == SamplingMethod::RandomizedSobol ? splitMix64(seed + replicate) : 0);
+			}
+
+			statistics[task] = simulateSamples(params, samples, seed, chunk, sequence, 1 + first, brownian_bridge, scratch.data() + worker * worker_scratch);
+		}
+	};
+
+	for (std::size_t worker{ 1 }; worker < number_of_threads; ++worker)
+	{
+		workers.emplace_back(run_worker, worker);
+	}
+	run_worker(0);
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	while (!worker_sequences.empty())
+	{
+		worker_sequences.pop_back();
+	}
+}
+
+/*
+	@simulateSamples: Payoff statistics of number_of_samples samples, scratch holds sampleScratchSize(params, sobol_sequence) doubles
+	-.Pseudo-random (sobol_sequence == nullptr): the normals are drawn from the given stream of seed with params.random_engine
+	-.Sobol: the normals are the points of sobol_sequence (a copy owned by the caller) from first_index on, through the Brownian bridge
+	-.The option type is resolved here, once per call, so the payoff loop of every path is specialized
+*/
+[[nodiscard]] PayoffStatistics FinancialCalculator::simulateSamples(const MonteCarloParams& params, const std::size_t number_of_samples, const std::uint64_t seed,
+	const std::uint64_t stream, SobolSequence* sobol_sequence, const std::uint64_t first_index, const BrownianBridge* brownian_bridge, double* scratch) const
+{
+	FC_METRICS_SCOPE(MonteCarloSimulation);
+	FC_METRICS_ITEMS(params.variance_reduction == VarianceReduction::Antithetic ? 2 * number_of_samples : number_of_samples);
+
+	double* const source_buffers = scratch;
+	double* const path_scratch = scratch + sourceScratchSize(sobol_sequence);
+
+	const auto simulate = [this, &params, number_of_samples, path_scratch](auto& normal_source)
+	{
+		return params.option_type == OptionType::Call ?
+			simulatePayoffs<OptionType::Call>(params, number_of_samples, normal_source, path_scratch) :
+			simulatePayoffs<OptionType::Put>(params, number_of_samples, normal_source, path_scratch);
+	};
+
+	if (sobol_sequence != nullptr)
+	{
+		SobolNormals normal_source(*sobol_sequence, *brownian_bridge, first_index, source_buffers);
+		return simulate(normal_source);
+	}
+
+	switch (params.random_engine)
+	{
+	case RandomEngine::Xoshiro256:
+	{
+		PseudoRandomNormals<Xoshiro256PlusPlus> normal_source(seed, stream, source_buffers);
+		return simulate(normal_source);
+	}
+	case RandomEngine::Philox:
+	{
+		PseudoRandomNormals<Philox4x32> normal_source(seed, stream, source_buffers);
+		return simulate(normal_source);
+	}
+	default:
+	{
+		PseudoRandomNormals<MersenneTwisterEngine> normal_source(seed, stream, source_buffers);
+		return simulate(normal_source);
+	}
+	}
+}
+
+/*
+	@simulatePayoffs: Simulates number_of_samples GBM samples (a path, or a pair of mirrored paths when antithetic) and returns their
+	undiscounted payoff statistics
+	-.path_scratch holds 4 * MONTE_CARLO_BLOCK_SIZE doubles: the prices of the block and of its mirror, then their running statistics,
+	followed by the BasketPaths scratch in multi-asset mode (the prices of the block are then the basket values)
+	-.Knock-out barriers stop simulating the paths (pairs) that are out, their payoff is 0:
+		-. with exchangeable normals (pseudo-random) the dead paths are swapped out of the block, so the following steps draw
+		and move only the live ones
+		-. with Sobol points (each path owns its coordinates) the block only stops once every path is out
+		-. with a control variate the terminal price of every path is needed, so nothing stops early
+		-. a basket keeps its assets' rows in place, the block only stops once every path is out
+*/
+template<OptionType Type, typename NormalSource>
+[[nodiscard]] PayoffStatistics FinancialCalculator::simulatePayoffs(const MonteCarloParams& params, const std::size_t number_of_samples, NormalSource& normal_source,
+	double* path_scratch) const
+{
+	PayoffStatistics statistics;
+	statistics.samples = number_of_samples;
+
+	const bool antithetic = params.variance_reduction == VarianceReduction::Antithetic;
+	const bool control_variate = params.variance_reduction == VarianceReduction::ControlVariate;
+	const bool spot_control = params.path_payoff == PathPayoff::European;
+
+	const Price strike_price = params.strike_price;
+	const PathStatistic path_statistic = pathStatistic(params.path_payoff, Type);
+	const bool knock_out = (params.path_payoff == PathPayoff::UpAndOut || params.path_payoff == PathPayoff::DownAndOut) && !control_variate;
+	const bool multi_asset = !params.assets.empty();
+	const bool compact = knock_out && NormalSource::EXCHANGEABLE_PATHS && !multi_asset;
+
+	// GBM has an exact solution, S(t + Δt) = S(t) * e^((r - σ²/2)Δt + σ√Δt Z), so a terminal-only path is a single step of Δt = T
+	const std::size_t total_steps = monteCarloSteps(params);
+	const double time_step = params.time / total_steps;
+
+	const auto payoff = [&params, strike_price, total_steps](const Price underlying_price, const double statistic)
+	{
+		return pathPayoff<Type>(params.path_payoff, underlying_price, statistic, strike_price, total_steps);
+	};
+
+	// Loop invariants of the GBM update
+	const auto drift = (params.interest_rate - 0.5 * params.volatility * params.volatility) * time_step;
+	const auto diffusion_scale = params.volatility * std::sqrt(time_step);
+
+	// The samples are simulated a block of paths at a time: every step takes the normals of the whole block at once
+	// and moves all of its paths with one vectorized GBM update, then updates their running statistics
+	Price* const underlying_prices = path_scratch;
+	Price* const mirrored_prices = path_scratch + MONTE_CARLO_BLOCK_SIZE;
+	double* const path_statistics = path_scratch + 2 * MONTE_CARLO_BLOCK_SIZE;
+	double* const mirrored_statistics = path_scratch + 3 * MONTE_CARLO_BLOCK_SIZE;
+
+	BasketPaths basket_paths(params, time_step, path_scratch + 4 * MONTE_CARLO_BLOCK_SIZE);
+	const Price initial_price = multi_asset ? basket_paths.initialValue() : params.underlying_price;
+	const double initial_statistic = initialPathStatistic(path_statistic, initial_price, params.barrier);
+
+	for (std::size_t first{ 0 }; first < number_of_samples; first += MONTE_CARLO_BLOCK_SIZE)
+	{
+		const std::size_t block_size = std::min(MONTE_CARLO_BLOCK_SIZE, number_of_samples - first);
+		normal_source.beginBlock(block_size);
+
+		// Reset underlying price for each simulation
+		std::fill_n(underlying_prices, block_size, initial_price);
+		std::fill_n(mirrored_prices, antithetic ? block_size : 0, initial_price);
+		if (multi_asset) basket_paths.beginBlock(block_size, antithetic);
+		std::fill_n(path_statistics, block_size, initial_statistic);
+		std::fill_n(mirrored_statistics, antithetic ? block_size : 0, initial_statistic);
+
+		// Paths [0, live) are still simulated, a knock-out spot is out before the first step
+		std::size_t live = knock_out && initial_statistic != 0.0 ? 0 : block_size;
+
+		for (std::size_t step{ 0 }; step < total_steps && live != 0; ++step)
+		{
+			// Geometric Brownian Motion (the mirrored paths use -Z, that is the opposite diffusion)
+			if (multi_asset)
+			{
+				basket_paths.step(normal_source, step, live, antithetic, underlying_prices, mirrored_prices);
+			}
+			else
+			{
+				const double* normals = normal_source.stepNormals(step, live);
+				gbmStepBatch(underlying_prices, normals, live, drift, diffusion_scale);
+				if (antithetic) gbmStepBatch(mirrored_prices, normals, live, drift, -diffusion_scale);
+			}
+
+			updatePathStatistic(path_statistic, underlying_prices, path_statistics, live, params.barrier);
+			if (antithetic) updatePathStatistic(path_statistic, mirrored_prices, mirrored_statistics, live, params.barrier);
+
+			if (knock_out)
+			{
+				live = compact ? removeKnockedOut(underlying_prices, path_statistics, mirrored_prices, antithetic ? mirrored_statistics : nullptr, live) :
+					(anyAlive(path_statistics, antithetic ? mirrored_statistics : nullptr, live) ? live : 0);
+			}
+		}
+
+		// The paths swapped out of the block are knocked out, they add a 0 payoff to the sums
+		const std::size_t priced = compact ? live : block_size;
+		for (std::size_t i{ 0 }; i < priced; ++i)
+		{
+			const Price sample_payoff = antithetic ? 0.5 * (payoff(underlying_prices[i], path_statistics[i]) + payoff(mirrored_prices[i], mirrored_statistics[i])) :
+				payoff(underlying_prices[i], path_statistics[i]);
+			statistics.sum += sample_payoff;
+			statistics.sum_squares += sample_payoff * sample_payoff;
+
+			if (control_variate)
+			{
+				const Price control_payoff = spot_control ? underlying_prices[i] : intrinsicValue<Type>(underlying_prices[i], strike_price);
+				statistics.control_sum += control_payoff;
+				statistics.control_sum_squares += control_payoff * control_payoff;
+				statistics.cross_sum += control_payoff * sample_payoff;
+			}
+		}
+	}
+
+	return statistics;
+}
+
+/*
+	@inverseNormalCdf: Acklam's rational approximation (relative error 1.15e-9) refined by one Halley step on normalCdf,
+	which brings it to full double precision
+*/
+[[nodiscard]] double inverseNormalCdf(double p) noexcept
+{
+	constexpr double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+	constexpr double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+	constexpr double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+	constexpr double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+	constexpr double P_LOW = 0.02425;
+
+	double x{};
+	if (p < P_LOW)
+	{
+		const double q = std::sqrt(-2.0 * std::log(p));
+		x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+	}
+	else if (p <= 1.0 - P_LOW)
+	{
+		const double q = p - 0.5;
+		const double r = q * q;
+		x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+	}
+	else
+	{
+		const double q = std::sqrt(-2.0 * std::log(1.0 - p));
+		x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+	}
+
+	const double error = normalCdf(x) - p;
+	const double u = error * std::sqrt(2.0 * MATH_PI) * std::exp(0.5 * x * x);
+	return x - u / (1.0 + 0.5 * x * u);
+}
+
+namespace
+{
+	constexpr std::size_t CLOSED_FORM_BATCH_SIZE = 1024;	// Most closed form jobs priced by one task, larger bursts are split across the workers
+
+	// Submitted closed form jobs with the promises of their results, priced on the backend of the calculators that submitted them
+	template<typename Params, typename Result>
+	struct ClosedFormJobs
+	{
+		std::vector<Params> params{};
+		std::vector<std::promise<Result>> promises{};
+		ComputeBackend backend{ ComputeBackend::Cpu };
+	};
+
+	// @closedFormBatchSize : Most jobs priced by one task, the device batches are kept large enough for the device to take them
+	[[nodiscard]] constexpr std::size_t closedFormBatchSize(const ComputeBackend backend) noexcept
+	{
+		return backend == ComputeBackend::Gpu ? std::max(CLOSED_FORM_BATCH_SIZE, GPU_MIN_CHAIN_SIZE) : CLOSED_FORM_BATCH_SIZE;
+	}
+
+	// Queue of the jobs submitted for one backend
+	template<typename Params, typename Result>
+	struct ClosedFormQueue
+	{
+		ComputeBackend backend{ ComputeBackend::Cpu };
+		std::mutex mutex{};
+		ClosedFormJobs<Params, Result> jobs{};
+		bool scheduled{ false };	// A task will price the queued jobs
+	};
+
+	// @isBatchable : The job passes the validation of the batch chain pricer, the others are priced (and throw) one by one
+	[[nodiscard]] bool isBatchable(const BlackScholesParams& params) noexcept
+	{
+		return params.option_type == OptionType::Call || params.option_type == OptionType::Put;
+	}
+
+	[[nodiscard]] bool isBatchable(const GreeksParams& params) noexcept
+	{
+		return params.time > 0 && params.volatility > 0 && (params.option_type == OptionType::Call || params.option_type == OptionType::Put);
+	}
+
+	[[nodiscard]] Price priceClosedForm(const FinancialCalculator& calculator, const BlackScholesParams& params) { return calculator.calculateBlackScholes(params); }
+	[[nodiscard]] OptionGreeks priceClosedForm(const FinancialCalculator& calculator, const GreeksParams& params) { return calculator.calculateGreeks(params); }
+
+	// Chain columns of the batchable jobs of a task, taken from the scratch arena of its worker
+	struct SubmittedChain
+	{
+		std::pmr::vector<Price> underlying_price;
+		std::pmr::vector<Price> strike_price;
+		std::pmr::vector<Time> time;
+		std::pmr::vector<Volatility> volatility;
+		std::pmr::vector<InterestRate> interest_rate;
+		std::pmr::vector<DividendYield> dividend_yield;
+		std::pmr::vector<OptionType> option_type;
+		std::pmr::vector<std::size_t> jobs;	// Index of the job of every row
+
+		SubmittedChain(const std::size_t capacity, std::pmr::memory_resource* resource)
+			: underlying_price(resource), strike_price(resource), time(resource), volatility(resource), interest_rate(resource), dividend_yield(resource),
+			option_type(resource), jobs(resource)
+		{
+			underlying_price.reserve(capacity);
+			strike_price.reserve(capacity);
+			time.reserve(capacity);
+			volatility.reserve(capacity);
+			interest_rate.reserve(capacity);
+			dividend_yield.reserve(capacity);
+			option_type.reserve(capacity);
+			jobs.reserve(capacity);
+		}
+
+		template<typename Params>
+		void append(const Params& params, const std::size_t job)
+		{
+			underlying_price.push_back(params.underlying_price);
+			strike_price.push_back(params.strike_price);
+			time.push_back(params.time);
+			volatility.push_back(params.volatility);
+			interest_rate.push_back(params.interest_rate);
+			if constexpr (std::is_same_v<Params, GreeksParams>) dividend_yield.push_back(params.dividend_yield);
+			option_type.push_back(params.option_type);
+			jobs.push_back(job);
+		}
+
+		[[nodiscard]] OptionChain view() const noexcept
+		{
+			return OptionChain{ underlying_price.data(), strike_price.data(), time.data(), volatility.data(), interest_rate.data(), option_type.data(),
+				dividend_yield.empty() ? nullptr : dividend_yield.data(), jobs.size() };
+		}
+	};
+
+	void priceChain(const FinancialCalculator& calculator, const SubmittedChain& chain, ClosedFormJobs<BlackScholesParams, Price>& jobs, std::pmr::memory_resource* resource)
+	{
+		std::pmr::vector<Price> prices(chain.jobs.size(), resource);
+		calculator.calculateBlackScholes(chain.view(), prices.data());
+
+		for (std::size_t row{ 0 }; row < chain.jobs.size(); ++row)
+		{
+			jobs.promises[chain.jobs[row]].set_value(prices[row]);
+		}
+	}
+
+	void priceChain(const FinancialCalculator& calculator, const SubmittedChain& chain, ClosedFormJobs<GreeksParams, OptionGreeks>& jobs, std::pmr::memory_resource* resource)
+	{
+		const std::size_t size = chain.jobs.size();
+		std::pmr::vector<double> columns(6 * size, resource);
+		const OptionGreeksChain greeks{ columns.data(), columns.data() + size, columns.data() + 2 * size, columns.data() + 3 * size, columns.data() + 4 * size, columns.data() + 5 * size };
+		calculator.calculateGreeks(chain.view(), greeks);
+
+		for (std::size_t row{ 0 }; row < size; ++row)
+		{
+			jobs.promises[chain.jobs[row]].set_value(OptionGreeks{ greeks.price[row], greeks.delta[row], greeks.gamma[row], greeks.theta[row], greeks.vega[row], greeks.rho[row] });
+		}
+	}
+
+	// @priceJobs : Prices the batchable jobs through the chain kernels and the others one by one, every promise gets its value or exception
+	template<typename Params, typename Result>
+	void priceJobs(ClosedFormJobs<Params, Result>& jobs) noexcept
+	{
+		FinancialCalculator calculator;
+		calculator.setComputeBackend(jobs.backend);
+		std::pmr::memory_resource* resource = &threadScratchArena();
+
+		try
+		{
+			SubmittedChain chain(jobs.params.size(), resource);
+			for (std::size_t job{ 0 }; job < jobs.params.size(); ++job)
+			{
+				if (isBatchable(jobs.params[job]))
+				{
+					chain.append(jobs.params[job], job);
+					continue;
+				}
+
+				try
+				{
+					jobs.promises[job].set_value(priceClosedForm(calculator, jobs.params[job]));
+				}
+				catch (...)
+				{
+					jobs.promises[job].set_exception(std::current_exception());
+				}
+			}
+
+			priceChain(calculator, chain, jobs, resource);
+		}
+		catch (...)
+		{
+			// Only an allocation can fail here, the jobs not priced yet get its exception
+			for (auto& promise : jobs.promises)
+			{
+				try
+				{
+					promise.set_exception(std::current_exception());
+				}
+				catch (const std::future_error&)
+				{
+				}
+			}
+		}
+	}
+
+	// @flushJobs : Takes every queued job, schedules the batches beyond the first and prices the first one
+	template<typename Params, typename Result>
+	void flushJobs(TaskScheduler& scheduler, ClosedFormQueue<Params, Result>& queue) noexcept
+	{
+		ClosedFormJobs<Params, Result> jobs;
+		{
+			const std::lock_guard<std::mutex> lock(queue.mutex);
+			std::swap(jobs, queue.jobs);
+			queue.scheduled = false;
+		}
+		jobs.backend = queue.backend;
+		const std::size_t batch_size = closedFormBatchSize(jobs.backend);
+
+		try
+		{
+			while (jobs.params.size() > batch_size)
+			{
+				const auto first = static_cast<std::ptrdiff_t>(jobs.params.size() - batch_size);
+
+				ClosedFormJobs<Params, Result> batch;
+				batch.backend = jobs.backend;
+				batch.params.assign(jobs.params.begin() + first, jobs.params.end());
+				batch.promises.assign(std::make_move_iterator(jobs.promises.begin() + first), std::make_move_iterator(jobs.promises.end()));
+				jobs.params.erase(jobs.params.begin() + first, jobs.params.end());
+				jobs.promises.erase(jobs.promises.begin() + first, jobs.promises.end());
+
+				scheduler.schedule([batch = std::move(batch)]() mutable noexcept { priceJobs(batch); });
+			}
+		}
+		catch (...)
+		{
+			// Out of memory while splitting, the remaining jobs are priced by this task
+		}
+
+		priceJobs(jobs);
+	}
+
+	// @enqueueJob : Queues a closed form job, the first job of an empty queue schedules the task that flushes it
+	template<typename Params, typename Result>
+	[[nodiscard]] std::future<Result> enqueueJob(TaskScheduler& scheduler, const std::shared_ptr<ClosedFormQueue<Params, Result>>& queue, const Params& params)
+	{
+		std::promise<Result> promise;
+		std::future<Result> future = promise.get_future();
+
+		bool schedule{ false };
+		{
+			const std::lock_guard<std::mutex> lock(queue->mutex);
+			queue->jobs.params.push_back(params);
+			queue->jobs.promises.push_back(std::move(promise));
+			schedule = !std::exchange(queue->scheduled, true);
+		}
+
+		if (schedule)
+		{
+			try
+			{
+				scheduler.schedule([&scheduler, queue]() noexcept { flushJobs(scheduler, *queue); });
+			}
+			catch (...)
+			{
+				// The job stays queued for the task of the next submission
+				const std::lock_guard<std::mutex> lock(queue->mutex);
+				queue->scheduled = false;
+				throw;
+			}
+		}
+		return future;
+	}
+
+	// Tasks of one asynchronous request: the first error wins and skips the tasks not started yet, the last task to finish completes it
+	struct AsyncRequest
+	{
+		PricingControl control{};
+		std::atomic<std::size_t> remaining{};
+		std::atomic<bool> failed{ false };
+		std::mutex error_mutex{};
+		std::exception_ptr error{};
+
+		void fail(const std::exception_ptr failure) noexcept
+		{
+			const std::lock_guard<std::mutex> lock(error_mutex);
+			if (!error) error = failure;
+			failed.store(true, std::memory_order_release);
+		}
+
+		// @finishTasks : True for the call that finishes the last task of the request
+		[[nodiscard]] bool finishTasks(const std::size_t count) noexcept { return remaining.fetch_sub(count, std::memory_order_acq_rel) == count; }
+	};
+
+	/*
+		@scheduleTasks: Schedules run(request, task) for the tasks [0, tasks) of the request, then request.finish() runs after the last one
+		-.Every task checks the control first, a cancelled / expired / failed request skips run
+		-.The tasks that can't be scheduled fail the request, the last task running (or this call) completes it
+	*/
+	template<typename Request, typename Run>
+	void scheduleTasks(TaskScheduler& scheduler, const std::shared_ptr<Request>& request, const std::size_t tasks, const Run& run) noexcept
+	{
+		request->remaining.store(tasks, std::memory_order_relaxed);
+
+		for (std::size_t task{ 0 }; task < tasks; ++task)
+		{
+			try
+			{
+				scheduler.schedule([request, task, run]() noexcept
+				{
+					try
+					{
+						if (!request->failed.load(std::memory_order_acquire))
+						{
+							request->control.check();
+							run(*request, task);
+						}
+					}
+					catch (...)
+					{
+						request->fail(std::current_exception());
+					}
+
+					if (request->finishTasks(1)) request->finish();
+				});
+			}
+			catch (...)
+			{
+				request->fail(std::current_exception());
+				if (request->finishTasks(tasks - task)) request->finish();
+				return;
+			}
+		}
+	}
+
+	/*
+		Asynchronous Monte Carlo request, the partial statistics of its tasks are merged by the last one
+		-.A progressive request runs its rounds one after the other: the chunks of a round are its tasks, the last one to finish
+		folds them into the run and schedules the next round (schedule_round), or completes the request
+	*/
+	struct MonteCarloRequest : AsyncRequest, std::enable_shared_from_this<MonteCarloRequest>
+	{
+		MonteCarloParams params{};
+		MonteCarloPlan plan{};
+		std::size_t tasks_per_replicate{ 1 };
+		std::vector<SobolSequence> sequences{};		// Shifted point set of every replicate (quasi-random sampling only)
+		std::unique_ptr<BrownianBridge> brownian_bridge{};
+		std::vector<PayoffStatistics> partial_statistics{};	// Replicate-major, one per task
+		bool on_device{ false };				// A single task runs the whole request on the GPU backend
+		std::unique_ptr<ProgressiveRun> progressive{};		// Progressive requests only
+		std::function<void(const std::shared_ptr<MonteCarloRequest>&)> schedule_round{};
+		PricingCallback<MonteCarloResult> callback{};
+
+		// @finish : Merges the partial statistics in task order, so the result doesn't depend on the order the tasks ran in
+		void finish() noexcept
+		{
+			if (!error && progressive != nullptr)
+			{
+				try
+				{
+					if (!progressive->endRound())
+					{
+						progressive->beginRound();
+						schedule_round(shared_from_this());
+						return;
+					}
+				}
+				catch (...)
+				{
+					fail(std::current_exception());
+				}
+			}
+
+			if (error)
+			{
+				callback(MonteCarloResult{}, error);
+				return;
+			}
+			if (progressive != nullptr)
+			{
+				callback(progressive->result(), nullptr);
+				return;
+			}
+
+			if (sequences.empty())
+			{
+				PayoffStatistics statistics;
+				for (const auto& partial : partial_statistics)
+				{
+					statistics += partial;
+				}
+				callback(pseudoRandomResult(statistics, params, plan), nullptr);
+				return;
+			}
+
+			double sum_estimates{ 0.0 };
+			double sum_squared_estimates{ 0.0 };
+			for (std::size_t replicate{ 0 }; replicate < plan.replicates; ++replicate)
+			{
+				PayoffStatistics statistics;
+				for (std::size_t task{ 0 }; task < tasks_per_replicate; ++task)
+				{
+					statistics += partial_statistics[replicate * tasks_per_replicate + task];
+				}
+
+				const double estimate = estimatePayoff(statistics, params, plan.control_expected).mean;
+				sum_estimates += estimate;
+				sum_squared_estimates += estimate * estimate;
+			}
+			callback(replicatesResult(sum_estimates, sum_squared_estimates, plan), nullptr);
+		}
+	};
+
+	// Asynchronous chain request, the slices are priced in place
+	struct ChainRequest : AsyncRequest
+	{
+		ChainPricingCallback callback{};
+
+		void finish() noexcept { callback(error); }
+	};
+
+	// @chainSlice : Contracts [first, first + size) of the chain
+	[[nodiscard]] OptionChain chainSlice(const OptionChain& chain, const std::size_t first, const std::size_t size) noexcept
+	{
+		return OptionChain{ chain.underlying_price + first, chain.strike_price + first, chain.time + first, chain.volatility + first, chain.interest_rate + first,
+			chain.option_type + first, chain.dividend_yield != nullptr ? chain.dividend_yield + first : nullptr, size };
+	}
+
+	// @chainTaskSize : Contracts per task of a chain request, a chain the device takes is priced by a single task (the slices would be too small for it)
+	[[nodiscard]] std::size_t chainTaskSize(const ComputeBackend backend, const std::size_t size) noexcept
+	{
+		return backend == ComputeBackend::Gpu && size >= GPU_MIN_CHAIN_SIZE && gpuAvailable() ? size : CHAIN_TASK_SIZE;
+	}
+
+	[[nodiscard]] std::size_t chainTasks(const std::size_t size, const std::size_t task_size) noexcept
+	{
+		return std::max<std::size_t>(1, (size + task_size - 1) / task_size);
+	}
+}
+
+// Closed form queues of one scheduler
+struct FinancialCalculator::SubmissionBatches
+{
+	// One queue per ComputeBackend (indexed by its value), a calculator submits to the queue of its backend
+	ClosedFormQueue<BlackScholesParams, Price> black_scholes[2]{ { ComputeBackend::Cpu }, { ComputeBackend::Gpu } };
+	ClosedFormQueue<GreeksParams, OptionGreeks> greeks[2]{ { ComputeBackend::Cpu }, { ComputeBackend::Gpu } };
+};
+
+FinancialCalculator::FinancialCalculator(TaskScheduler& scheduler, std::pmr::memory_resource* scratch_resource)
+	: scratch_resource_(scratch_resource), scheduler_(&scheduler), batches_(std::make_shared<SubmissionBatches>()) {}
+
+[[nodiscard]] std::shared_ptr<FinancialCalculator::SubmissionBatches> FinancialCalculator::submissionBatches() const
+{
+	if (batches_ != nullptr) return batches_;
+
+	static const std::shared_ptr<SubmissionBatches> shared_batches = std::make_shared<SubmissionBatches>();
+	return shared_batches;
+}
+
+[[nodiscard]] std::future<Price> FinancialCalculator::submitBlackScholes(const BlackScholesParams& params) const
+{
+	const std::shared_ptr<SubmissionBatches> batches = submissionBatches();
+	return enqueueJob(getScheduler(), std::shared_ptr<ClosedFormQueue<BlackScholesParams, Price>>(batches, &batches->black_scholes[static_cast<std::size_t>(compute_backend_)]), params);
+}
+
+[[nodiscard]] std::future<OptionGreeks> FinancialCalculator::submitGreeks(const GreeksParams& params) const
+{
+	const std::shared_ptr<SubmissionBatches> batches = submissionBatches();
+	return enqueueJob(getScheduler(), std::shared_ptr<ClosedFormQueue<GreeksParams, OptionGreeks>>(batches, &batches->greeks[static_cast<std::size_t>(compute_backend_)]), params);
+}
+
+[[nodiscard]] std::future<MonteCarloResult> FinancialCalculator::submitMonteCarlo(const MonteCarloParams& params) const
+{
+	auto promise = std::make_shared<std::promise<MonteCarloResult>>();
+	std::future<MonteCarloResult> future = promise->get_future();
+
+	calculateMonteCarloAsync(params, [promise](const MonteCarloResult result, const std::exception_ptr error)
+	{
+		if (error) promise->set_exception(error);
+		else promise->set_value(result);
+	});
+	return future;
+}
+
+/*
+	@calculateMonteCarloAsync: Splits the request into tasks of MONTE_CARLO_TASK_SAMPLES samples per replicate
+	-.Task t draws from stream t of the seed (pseudo-random) or takes the point indices [1 + t * MONTE_CARLO_TASK_SAMPLES, ...) of its
+	replicate (Sobol), on a copy of the replicate sequence allocated with its scratch from the arena of the worker
+	-.The request itself (sequences, bridge, partial statistics) lives on the global heap, it outlives the call
+	-.Invalid params fail the request: the callback still runs on a worker, from a single task
+	-.A progressive request (target standard error / time budget) schedules the chunks of each round of its ProgressiveRun as tasks
+	(the first round has a chunk per scheduler worker), the control is checked before every task and between the rounds, and its
+	deadline bounds the size of the rounds like the time budget
+*/
+void FinancialCalculator::calculateMonteCarloAsync(const MonteCarloParams& params, PricingCallback<MonteCarloResult> callback, const PricingControl& control) const
+{
+	auto request = std::make_shared<MonteCarloRequest>();
+	request->control = control;
+	request->callback = std::move(callback);
+
+	std::size_t tasks{ 1 };
+	try
+	{
+		request->params = params;
+		request->plan = planMonteCarlo(*this, params);
+
+		const MonteCarloPlan& plan = request->plan;
+		request->tasks_per_replicate = std::max<std::size_t>(1, (plan.samples_per_replicate + MONTE_CARLO_TASK_SAMPLES - 1) / MONTE_CARLO_TASK_SAMPLES);
+
+		if (params.sampling_method != SamplingMethod::PseudoRandom)
+		{
+			const std::size_t steps = monteCarloSteps(params);
+			request->brownian_bridge = std::make_unique<BrownianBridge>(steps);
+			request->sequences.reserve(plan.replicates);
+			for (std::size_t replicate{ 0 }; replicate < plan.replicates; ++replicate)
+			{
+				request->sequences.emplace_back(steps);
+				if (params.sampling_method == SamplingMethod::RandomizedSobol) request->sequences.back().setDigitalShift(splitMix64(plan.seed + replicate));
+			}
+		}
+
+		if (plan.progressive)
+		{
+			request->progressive = std::make_unique<ProgressiveRun>(request->params, plan, getScheduler().size(), &request->control, std::pmr::get_default_resource());
+			request->progressive->beginRound();
+			tasks = request->progressive->replicates() * request->progressive->roundChunks();
+
+			// Task t of a round simulates chunk firstChunk() + t % roundChunks() of replicate t / roundChunks(), like runMonteCarloChunks
+			request->schedule_round = [calculator = *this](const std::shared_ptr<MonteCarloRequest>& job)
+			{
+				ProgressiveRun& run = *job->progressive;
+				scheduleTasks(calculator.getScheduler(), job, run.replicates() * run.roundChunks(), [calculator](MonteCarloRequest& round_job, const std::size_t task)
+				{
+					ProgressiveRun& round = *round_job.progressive;
+					const std::size_t replicate = task / round.roundChunks();
+					const std::size_t chunk = round.firstChunk() + task % round.roundChunks();
+					const std::size_t first = chunk * MONTE_CARLO_TASK_SAMPLES;
+					const std::size_t samples = std::min(MONTE_CARLO_TASK_SAMPLES, round.sampleLimit() - std::min(first, round.sampleLimit()));
+
+					std::pmr::memory_resource* resource = &threadScratchArena();
+					if (round_job.sequences.empty())
+					{
+						std::pmr::vector<double> scratch(sampleScratchSize(round_job.params, nullptr), resource);
+						round.roundStatistics()[task] = calculator.simulateSamples(round_job.params, samples, round_job.plan.seed, chunk, nullptr, 0, nullptr, scratch.data());
+						return;
+					}
+
+					SobolSequence sequence(round_job.sequences[replicate], resource);
+					std::pmr::vector<double> scratch(sampleScratchSize(round_job.params, &sequence), resource);
+					round.roundStatistics()[task] = calculator.simulateSamples(round_job.params, samples, round_job.plan.seed, chunk, &sequence, 1 + first,
+						round_job.brownian_bridge.get(), scratch.data());
+				});
+			};
+		}
+		else if (compute_backend_ == ComputeBackend::Gpu && gpuSupportsMonteCarlo(params) && gpuAvailable())
+		{
+			request->on_device = true;
+			request->partial_statistics.resize(1);
+		}
+		else
+		{
+			tasks = plan.replicates * request->tasks_per_replicate;
+			request->partial_statistics.resize(tasks);
+		}
+	}
+	catch (...)
+	{
+		request->fail(std::current_exception());
+		request->progressive.reset();
+		tasks = 1;
+	}
+
+	if (request->progressive != nullptr)
+	{
+		request->schedule_round(request);
+		return;
+	}
+
+	scheduleTasks(getScheduler(), request, tasks, [calculator = *this](MonteCarloRequest& job, const std::size_t task)
+	{
+		const std::size_t replicate = task / job.tasks_per_replicate;
+		const std::size_t first = (task % job.tasks_per_replicate) * MONTE_CARLO_TASK_SAMPLES;
+		const std::size_t samples = std::min(MONTE_CARLO_TASK_SAMPLES, job.plan.samples_per_replicate - std::min(first, job.plan.samples_per_replicate));
+
+		std::pmr::memory_resource* resource = &threadScratchArena();
+		if (job.on_device)
+		{
+			// One device launch for the whole request, a failed launch simulates the tasks here in task order (the CPU estimate)
+			PayoffStatistics statistics;
+			if (!gpuSimulatePayoffs(job.params, job.plan.number_of_samples, job.plan.seed, statistics))
+			{
+				statistics = PayoffStatistics{};
+				std::pmr::vector<double> scratch(sampleScratchSize(job.params, nullptr), resource);
+				for (std::size_t chunk{ 0 }; chunk < job.tasks_per_replicate; ++chunk)
+				{
+					const std::size_t chunk_first = chunk * MONTE_CARLO_TASK_SAMPLES;
+					const std::size_t chunk_samples = std::min(MONTE_CARLO_TASK_SAMPLES, job.plan.samples_per_replicate - std::min(chunk_first, job.plan.samples_per_replicate));
+					statistics += calculator.simulateSamples(job.params, chunk_samples, job.plan.seed, chunk, nullptr, 0, nullptr, scratch.data());
+				}
+			}
+			job.partial_statistics.front() = statistics;
+			return;
+		}
+
+		if (job.sequences.empty())
+		{
+			std::pmr::vector<double> scratch(sampleScratchSize(job.params, nullptr), resource);
+			job.partial_statistics[task] = calculator.simulateSamples(job.params, samples, job.plan.seed, task, nullptr, 0, nullptr, scratch.data());
+			return;
+		}
+
+		SobolSequence sequence(job.sequences[replicate], resource);
+		std::pmr::vector<double> scratch(sampleScratchSize(job.params, &sequence), resource);
+		job.partial_statistics[task] = calculator.simulateSamples(job.params, samples, job.plan.seed, task, &sequence, 1 + first, job.brownian_bridge.get(), scratch.data());
+	});
+}
+
+void FinancialCalculator::calculateBlackScholesAsync(const OptionChain& chain, Price* prices, ChainPricingCallback callback, const PricingControl& control) const
+{
+	auto request = std::make_shared<ChainRequest>();
+	request->control = control;
+	request->callback = std::move(callback);
+
+	const std::size_t task_size = chainTaskSize(compute_backend_, chain.size);
+	scheduleTasks(getScheduler(), request, chainTasks(chain.size, task_size), [calculator = *this, chain, prices, task_size](ChainRequest&, const std::size_t task)
+	{
+		const std::size_t first = std::min(task * task_size, chain.size);
+		calculator.calculateBlackScholes(chainSlice(chain, first, std::min(task_size, chain.size - first)), prices + first);
+	});
+}
+
+void FinancialCalculator::calculateGreeksAsync(const OptionChain& chain, const OptionGreeksChain& greeks, ChainPricingCallback callback, const PricingControl& control) const
+{
+	auto request = std::make_shared<ChainRequest>();
+	request->control = control;
+	request->callback = std::move(callback);
+
+	const std::size_t task_size = chainTaskSize(compute_backend_, chain.size);
+	scheduleTasks(getScheduler(), request, chainTasks(chain.size, task_size), [calculator = *this, chain, greeks, task_size](ChainRequest&, const std::size_t task)
+	{
+		const std::size_t first = std::min(task * task_size, chain.size);
+		const OptionGreeksChain slice{ greeks.price + first, greeks.delta + first, greeks.gamma + first, greeks.theta + first, greeks.vega + first, greeks.rho + first };
+		calculator.calculateGreeks(chainSlice(chain, first, std::min(task_size, chain.size - first)), slice);
+	});
+}
+
+Option::Option(Price strike, Price premium, OptionType option_type) : strike_(strike), premium_(premium), option_type_(option_type) {};
+
+PreparedOption::PreparedOption(const BlackScholesParams& params)
+	: PreparedOption(GreeksParams{ params.interest_rate, params.underlying_price, params.strike_price, params.time, params.volatility, params.option_type, params.paid_price, 0.0 }) {}
+
+PreparedOption::PreparedOption(const GreeksParams& params)
+{
+	if (params.time <= 0) throw std::runtime_error("[!] Time must be positive");
+	if (params.volatility <= 0) throw std::runtime_error("[!] Volatility must be positive");
+	if (params.option_type != OptionType::Call && params.option_type != OptionType::Put) throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+
+	sign_ = params.option_type == OptionType::Call ? 1.0 : -1.0;
+	sqrt_time_ = std::sqrt(params.time);
+	volatility_sqrt_time_ = params.volatility * sqrt_time_;
+	inverse_volatility_sqrt_time_ = 1.0 / volatility_sqrt_time_;
+	log_strike_ = std::log(params.strike_price);
+	drift_ = (params.interest_rate + (params.volatility * params.volatility) / 2.0) * params.time;
+	strike_discount_ = params.strike_price * std::exp(-params.interest_rate * params.time);
+	dividend_discount_ = std::exp(-params.dividend_yield * params.time);
+	time_ = params.time;
+	volatility_ = params.volatility;
+	interest_rate_ = params.interest_rate;
+	dividend_yield_ = params.dividend_yield;
+}
+
+[[nodiscard]] Price PreparedOption::reprice(const Price spot) const noexcept
+{
+	const double d1 = (std::log(spot) - log_strike_ + drift_) * inverse_volatility_sqrt_time_;
+	const double d2 = d1 - volatility_sqrt_time_;
+
+	return sign_ * (spot * dividend_discount_ * normalCdf(sign_ * d1) - strike_discount_ * normalCdf(sign_ * d2));
+}
+
+[[nodiscard]] OptionGreeks PreparedOption::repriceGreeks(const Price spot) const noexcept
+{
+	const double d1 = (std::log(spot) - log_strike_ + drift_) * inverse_volatility_sqrt_time_;
+	const double d2 = d1 - volatility_sqrt_time_;
+
+	const double cdf_d1 = normalCdf(sign_ * d1);
+	const double cdf_d2 = normalCdf(sign_ * d2);
+	const double pdf_d1 = normalPdf(d1);
+	const double spot_term = spot * dividend_discount_;
+
+	OptionGreeks greeks;
+	greeks.price = sign_ * (spot_term * cdf_d1 - strike_discount_ * cdf_d2);
+	greeks.delta = sign_ * dividend_discount_ * cdf_d1;
+	greeks.gamma = (dividend_discount_ * pdf_d1) / (spot * volatility_sqrt_time_);
+	greeks.theta = -(spot_term * volatility_ * pdf_d1) / (2 * sqrt_time_) - sign_ * (interest_rate_ * strike_discount_ * cdf_d2 - dividend_yield_ * spot_term * cdf_d1);
+	greeks.vega = spot_term * pdf_d1 * sqrt_time_;
+	greeks.rho = sign_ * strike_discount_ * time_ * cdf_d2;
+
+	return greeks;
+}
+
+PreparedOptionChain::PreparedOptionChain(const OptionChain& chain, std::pmr::memory_resource* resource)
+	: sign_(chain.size, resource), log_strike_minus_drift_(chain.size, resource), inverse_volatility_sqrt_time_(chain.size, resource),
+	volatility_sqrt_time_(chain.size, resource), sqrt_time_(chain.size, resource), strike_discount_(chain.size, resource), dividend_discount_(chain.size, resource),
+	time_(chain.size, resource), volatility_(chain.size, resource), interest_rate_(chain.size, resource), dividend_yield_(chain.size, resource),
+	d1_(chain.size, resource), cdf_d1_(chain.size, resource), cdf_d2_(chain.size, resource), pdf_d1_(chain.size, resource)
+{
+	for (std::size_t i{ 0 }; i < chain.size; ++i)
+	{
+		if (chain.time[i] <= 0) throw std::runtime_error("[!] Time must be positive");
+		if (chain.volatility[i] <= 0) throw std::runtime_error("[!] Volatility must be positive");
+		if (chain.option_type[i] != OptionType::Call && chain.option_type[i] != OptionType::Put)
+		{
+			throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+		}
+
+		const DividendYield dividend_yield = chain.dividend_yield != nullptr ? chain.dividend_yield[i] : 0.0;
+
+		sign_[i] = chain.option_type[i] == OptionType::Call ? 1.0 : -1.0;
+		sqrt_time_[i] = std::sqrt(chain.time[i]);
+		volatility_sqrt_time_[i] = chain.volatility[i] * sqrt_time_[i];
+		inverse_volatility_sqrt_time_[i] = 1.0 / volatility_sqrt_time_[i];
+		log_strike_minus_drift_[i] = std::log(chain.strike_price[i]) - (chain.interest_rate[i] + (chain.volatility[i] * chain.volatility[i]) / 2.0) * chain.time[i];
+		strike_discount_[i] = chain.strike_price[i] * std::exp(-chain.interest_rate[i] * chain.time[i]);
+		dividend_discount_[i] = std::exp(-dividend_yield * chain.time[i]);
+		time_[i] = chain.time[i];
+		volatility_[i] = chain.volatility[i];
+		interest_rate_[i] = chain.interest_rate[i];
+		dividend_yield_[i] = dividend_yield;
+	}
+}
+
+// @evaluateDistributions : d1_, N(±d1) and N(±d2) of every contract for the given spot (and φ(d1) when with_pdf is set)
+void PreparedOptionChain::evaluateDistributions(const Price spot, const bool with_pdf) noexcept
+{
+	const std::size_t size = sign_.size();
+	const double log_spot = std::log(spot);
+
+	// The arguments of the CDFs are staged in the output columns, the kernels read and write them in place
+	for (std::size_t i{ 0 }; i < size; ++i)
+	{
+		const double d1 = (log_spot - log_strike_minus_drift_[i]) * inverse_volatility_sqrt_time_[i];
+		d1_[i] = d1;
+		cdf_d1_[i] = sign_[i] * d1;
+		cdf_d2_[i] = sign_[i] * (d1 - volatility_sqrt_time_[i]);
+	}
+
+	normalCdfBatch(cdf_d1_.data(), cdf_d1_.data(), size);
+	normalCdfBatch(cdf_d2_.data(), cdf_d2_.data(), size);
+	if (with_pdf) normalPdfBatch(d1_.data(), pdf_d1_.data(), size);
+}
+
+void PreparedOptionChain::reprice(const Price spot, Price* prices) noexcept
+{
+	evaluateDistributions(spot, false);
+
+	for (std::size_t i{ 0 }; i < sign_.size(); ++i)
+	{
+		prices[i] = sign_[i] * (spot * dividend_discount_[i] * cdf_d1_[i] - strike_discount_[i] * cdf_d2_[i]);
+	}
+}
+
+void PreparedOptionChain::repriceGreeks(const Price spot, const OptionGreeksChain& greeks) noexcept
+{
+	evaluateDistributions(spot, true);
+
+	for (std::size_t i{ 0 }; i < sign_.size(); ++i)
+	{
+		const double spot_term = spot * dividend_discount_[i];
+
+		greeks.price[i] = sign_[i] * (spot_term * cdf_d1_[i] - strike_discount_[i] * cdf_d2_[i]);
+		greeks.delta[i] = sign_[i] * dividend_discount_[i] * cdf_d1_[i];
+		greeks.gamma[i] = (dividend_discount_[i] * pdf_d1_[i]) / (spot * volatility_sqrt_time_[i]);
+		greeks.theta[i] = -(spot_term * volatility_[i] * pdf_d1_[i]) / (2 * sqrt_time_[i])
+			- sign_[i] * (interest_rate_[i] * strike_discount_[i] * cdf_d2_[i] - dividend_yield_[i] * spot_term * cdf_d1_[i]);
+		greeks.vega[i] = spot_term * pdf_d1_[i] * sqrt_time_[i];
+		greeks.rho[i] = sign_[i] * strike_discount_[i] * time_[i] * cdf_d2_[i];
+	}
+}
+
+// @calculatePayoff: Simply calculates the option's payoff at expiration or current value if exercised immediately, minus the premium paid
+//	With direction = +1 for calls and -1 for puts both payoffs are max(direction * (S - K), 0) - premium, a branch-free form that vectorizes
+
+[[nodiscard]] double Option::calculatePayoff(Price spotPrice) const
+{
+	const double direction = option_type_ == OptionType::Call ? 1.0 : -1.0;
+	return std::max(direction * (spotPrice - strike_), 0.0) - premium_;
+}
+
+// @calculatePayoff (grid): payoffs[i] = calculatePayoff(spot_prices[i]) for i in [0, size)
+void Option::calculatePayoff(const Price* spot_prices, Price* payoffs, const std::size_t size) const noexcept
+{
+	const double direction = option_type_ == OptionType::Call ? 1.0 : -1.0;
+	const Price strike = strike_;
+	const Price premium = premium_;
+
+	for (std::size_t i{ 0 }; i < size; ++i)
+	{
+		payoffs[i] = std::max(direction * (spot_prices[i] - strike), 0.0) - premium;
+	}
+}
+
+// @accumulatePayoff: payoffs[i] += quantity * calculatePayoff(spot_prices[i]) for i in [0, size), used to add the legs of a strategy
+void Option::accumulatePayoff(const double quantity, const Price* spot_prices, Price* payoffs, const std::size_t size) const noexcept
+{
+	const double direction = option_type_ == OptionType::Call ? 1.0 : -1.0;
+	const Price strike = strike_;
+	const Price premium = premium_;
+
+	for (std::size_t i{ 0 }; i < size; ++i)
+	{
+		payoffs[i] += quantity * (std::max(direction * (spot_prices[i] - strike), 0.0) - premium);
+	}
+}
+
+MultiLegStrategy::MultiLegStrategy(std::vector<StrategyLeg> legs)
+{
+	legs_.reserve(legs.size());
+	for (const auto& leg : legs)
+	{
+		addLeg(leg.option, leg.quantity);
+	}
+}
+
+// @addLeg : Appends quantity units of option (negative quantities are sold), returns the strategy so the legs can be chained
+MultiLegStrategy& MultiLegStrategy::addLeg(const Option& option, const double quantity)
+{
+	if (option.getType() != OptionType::Call && option.getType() != OptionType::Put) throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+	if (!std::isfinite(quantity)) throw std::invalid_argument("[!] Leg quantity must be finite");
+
+	legs_.push_back({ option, quantity });
+	return *this;
+}
+
+// @getNetPremium : Premium paid for the whole structure (negative when the strategy is opened for a credit)
+[[nodiscard]] Price MultiLegStrategy::getNetPremium() const noexcept
+{
+	Price premium{ 0.0 };
+	for (const auto& leg : legs_)
+	{
+		premium += leg.quantity * leg.option.getPremium();
+	}
+	return premium;
+}
+
+// @calculatePayoff : Σ quantity * payoff of every leg at expiration for the given spot price
+[[nodiscard]] StrategyPayoff MultiLegStrategy::calculatePayoff(const Price spotPrice) const noexcept
+{
+	FC_METRICS_SCOPE_SAMPLED(StrategyPayoff);
+	FC_METRICS_ITEMS(1);
+
+	StrategyPayoff payoff{ 0.0 };
+	for (const auto& leg : legs_)
+	{
+		payoff += leg.quantity * leg.option.calculatePayoff(spotPrice);
+	}
+	return payoff;
+}
+
+// @calculatePayoff (grid): payoffs[i] = calculatePayoff(spot_prices[i]) for i in [0, size), one contiguous loop over the spots per leg
+void MultiLegStrategy::calculatePayoff(const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size) const noexcept
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	std::fill(payoffs, payoffs + size, 0.0);
+	for (const auto& leg : legs_)
+	{
+		leg.option.accumulatePayoff(leg.quantity, spot_prices, payoffs, size);
+	}
+}
+
+// @calculateBlackScholes : Black-Scholes value of the whole structure (the price of its Greeks)
+[[nodiscard]] Price MultiLegStrategy::calculateBlackScholes(const StrategyMarket& market) const
+{
+	return calculateGreeks(market).price;
+}
+
+/*
+	@calculateGreeks : Value and Greeks of the whole structure, the same formulas as FinancialCalculator::calculateGreeks summed over the legs
+	-.Everything that only depends on the market is hoisted out of the leg loop, each leg then costs one log, two CDFs and one PDF
+*/
+[[nodiscard]] OptionGreeks MultiLegStrategy::calculateGreeks(const StrategyMarket& market) const
+{
+	FC_METRICS_SCOPE(StrategyPricing);
+	FC_METRICS_ITEMS(legs_.size());
+
+	if (market.time <= 0) throw std::runtime_error("[!] Time must be positive");
+	if (market.volatility <= 0) throw std::runtime_error("[!] Volatility must be positive");
+
+	const double sqrt_time = std::sqrt(market.time);
+	const double volatility_sqrt_time = market.volatility * sqrt_time;
+	const double log_spot_drift = std::log(market.underlying_price) + (market.interest_rate + (market.volatility * market.volatility) / 2.0) * market.time;
+	const double discount = std::exp(-market.interest_rate * market.time);
+	const double dividend_discount = std::exp(-market.dividend_yield * market.time);
+	const double spot_term = market.underlying_price * dividend_discount;	// S * e^(-qT)
+
+	OptionGreeks total;
+	for (const auto& leg : legs_)
+	{
+		const double d1 = (log_spot_drift - std::log(leg.option.getStrike())) / volatility_sqrt_time;
+		const double d2 = d1 - volatility_sqrt_time;
+
+		const double sign = leg.option.getType() == OptionType::Call ? 1.0 : -1.0;
+		const double cdf_d1 = normalCdf(sign * d1);
+		const double cdf_d2 = normalCdf(sign * d2);
+		const double weighted_pdf_d1 = leg.quantity * normalPdf(d1);
+		const double signed_quantity = sign * leg.quantity;
+		const double strike_term = leg.option.getStrike() * discount;	// K * e^(-rT)
+
+		total.price += signed_quantity * (spot_term * cdf_d1 - strike_term * cdf_d2);
+		total.delta += signed_quantity * dividend_discount * cdf_d1;
+		total.gamma += weighted_pdf_d1;
+		total.theta += -(spot_term * market.volatility * weighted_pdf_d1) / (2 * sqrt_time)
+			- signed_quantity * (market.interest_rate * strike_term * cdf_d2 - market.dividend_yield * spot_term * cdf_d1);
+		total.vega += weighted_pdf_d1;
+		total.rho += signed_quantity * strike_term * market.time * cdf_d2;
+	}
+
+	// Gamma and vega only differ between legs through φ(d1), so their common factors are applied once
+	total.gamma *= dividend_discount / (market.underlying_price * volatility_sqrt_time);
+	total.vega *= spot_term * sqrt_time;
+
+	return total;
+}
+
+// @getPutSpread: A put spread is buying a put option with a higher strike price and selling a put option with a lower strike price
+[[nodiscard]] StrategyPayoff CalculateStrategy::getPutSpread(const Option& long_put, const Option& short_put, Price spotPrice) const
+{
+	FC_METRICS_SCOPE_SAMPLED(StrategyPayoff);
+	FC_METRICS_ITEMS(1);
+
+	validatePutSpread(long_put, short_put);
+	return long_put.calculatePayoff(spotPrice) - short_put.calculatePayoff(spotPrice);
+}
+
+// @getCallSpread: A call spread is buying a put option with a lower strike price and selling a put option with a higher strike price
+[[nodiscard]] StrategyPayoff CalculateStrategy::getCallSpread(const Option& long_call, const Option& short_call, Price spotPrice) const
+{
+	FC_METRICS_SCOPE_SAMPLED(StrategyPayoff);
+	FC_METRICS_ITEMS(1);
+
+	validateCallSpread(long_call, short_call);
+	return long_call.calculatePayoff(spotPrice) - short_call.calculatePayoff(spotPrice);
+}
+
+/*
+	@getButterfly: A butterfly is:
+		1-. Buying a call option with a lower strike price (which is the wing1)
+		2-. Selling two call options with a middle strike price (which is the body)
+		3-. Finally buying a call option with a higher strike price (which is the wing2).
+*/
+[[nodiscard]] StrategyPayoff CalculateStrategy::getButterfly(const Option& wing1, const Option& body, const Option& wing2, Price spotPrice) const
+{
+	FC_METRICS_SCOPE_SAMPLED(StrategyPayoff);
+	FC_METRICS_ITEMS(1);
+
+	validateButterfly(wing1, body, wing2);
+	return wing1.calculatePayoff(spotPrice) - 2.0 * body.calculatePayoff(spotPrice) + wing2.calculatePayoff(spotPrice);
+}
+
+// @getStrangle: A strangle is buying a put option with a lower strike price and buying a call option with a higher strike price.
+[[nodiscard]] StrategyPayoff CalculateStrategy::getStrangle(const Option& put, const Option& call, Price spotPrice) const
+{
+	FC_METRICS_SCOPE_SAMPLED(StrategyPayoff);
+	FC_METRICS_ITEMS(1);
+
+	validateStrangle(put, call);
+	return put.calculatePayoff(spotPrice) + call.calculatePayoff(spotPrice);
+}
+
+// @getStraddle : A straddle is buying a put option and a call option with the same strike price
+[[nodiscard]] StrategyPayoff CalculateStrategy::getStraddle(const Option& put, const Option& call, Price spotPrice) const
+{
+	FC_METRICS_SCOPE_SAMPLED(StrategyPayoff);
+	FC_METRICS_ITEMS(1);
+
+	validateStraddle(put, call);
+	return put.calculatePayoff(spotPrice) + call.calculatePayoff(spotPrice);
+}
+
+// Multi-leg versions of the fixed strategies, validated like their getters
+
+[[nodiscard]] MultiLegStrategy CalculateStrategy::makePutSpread(const Option& long_put, const Option& short_put)
+{
+	validatePutSpread(long_put, short_put);
+	return MultiLegStrategy{}.addLeg(long_put, 1.0).addLeg(short_put, -1.0);
+}
+
+[[nodiscard]] MultiLegStrategy CalculateStrategy::makeCallSpread(const Option& long_call, const Option& short_call)
+{
+	validateCallSpread(long_call, short_call);
+	return MultiLegStrategy{}.addLeg(long_call, 1.0).addLeg(short_call, -1.0);
+}
+
+[[nodiscard]] MultiLegStrategy CalculateStrategy::makeButterfly(const Option& wing1, const Option& body, const Option& wing2)
+{
+	validateButterfly(wing1, body, wing2);
+	return MultiLegStrategy{}.addLeg(wing1, 1.0).addLeg(body, -2.0).addLeg(wing2, 1.0);
+}
+
+[[nodiscard]] MultiLegStrategy CalculateStrategy::makeStrangle(const Option& put, const Option& call)
+{
+	validateStrangle(put, call);
+	return MultiLegStrategy{}.addLeg(put, 1.0).addLeg(call, 1.0);
+}
+
+[[nodiscard]] MultiLegStrategy CalculateStrategy::makeStraddle(const Option& put, const Option& call)
+{
+	validateStraddle(put, call);
+	return MultiLegStrategy{}.addLeg(put, 1.0).addLeg(call, 1.0);
+}
+
+// @makeIronCondor : Short strangle protected by a long strangle further out of the money (long put < short put < short call < long call)
+[[nodiscard]] MultiLegStrategy CalculateStrategy::makeIronCondor(const Option& long_put, const Option& short_put, const Option& short_call, const Option& long_call)
+{
+	validateIronCondor(long_put, short_put, short_call, long_call);
+	return MultiLegStrategy{}.addLeg(long_put, 1.0).addLeg(short_put, -1.0).addLeg(short_call, -1.0).addLeg(long_call, 1.0);
+}
+
+// Payoff grids: one validation, then every leg is added over the whole span of spots (one contiguous, vectorizable loop per leg)
+
+void CalculateStrategy::getPutSpread(const Option& long_put, const Option& short_put, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size) const
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	validatePutSpread(long_put, short_put);
+	long_put.calculatePayoff(spot_prices, payoffs, size);
+	short_put.accumulatePayoff(-1.0, spot_prices, payoffs, size);
+}
+
+void CalculateStrategy::getCallSpread(const Option& long_call, const Option& short_call, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size) const
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	validateCallSpread(long_call, short_call);
+	long_call.calculatePayoff(spot_prices, payoffs, size);
+	short_call.accumulatePayoff(-1.0, spot_prices, payoffs, size);
+}
+
+void CalculateStrategy::getButterfly(const Option& wing1, const Option& body, const Option& wing2, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size) const
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	validateButterfly(wing1, body, wing2);
+	wing1.calculatePayoff(spot_prices, payoffs, size);
+	body.accumulatePayoff(-2.0, spot_prices, payoffs, size);
+	wing2.accumulatePayoff(1.0, spot_prices, payoffs, size);
+}
+
+void CalculateStrategy::getStrangle(const Option& put, const Option& call, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size) const
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	validateStrangle(put, call);
+	put.calculatePayoff(spot_prices, payoffs, size);
+	call.accumulatePayoff(1.0, spot_prices, payoffs, size);
+}
+
+void CalculateStrategy::getStraddle(const Option& put, const Option& call, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size) const
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	validateStraddle(put, call);
+	put.calculatePayoff(spot_prices, payoffs, size);
+	call.accumulatePayoff(1.0, spot_prices, payoffs, size);
+}
+
+// Exception free payoff grids, an invalid strategy is reported in status and its payoffs are NaN
+
+namespace
+{
+	void fillInvalidPayoffs(StrategyPayoff* payoffs, const std::size_t size) noexcept
+	{
+		std::fill(payoffs, payoffs + size, std::numeric_limits<double>::quiet_NaN());
+	}
+}
+
+void CalculateStrategy::getPutSpread(const Option& long_put, const Option& short_put, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size,
+	PricingStatus& status) const noexcept
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	status = checkPutSpread(long_put, short_put);
+	if (status != PricingStatus::Ok)
+	{
+		fillInvalidPayoffs(payoffs, size);
+		return;
+	}
+	long_put.calculatePayoff(spot_prices, payoffs, size);
+	short_put.accumulatePayoff(-1.0, spot_prices, payoffs, size);
+}
+
+void CalculateStrategy::getCallSpread(const Option& long_call, const Option& short_call, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size,
+	PricingStatus& status) const noexcept
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	status = checkCallSpread(long_call, short_call);
+	if (status != PricingStatus::Ok)
+	{
+		fillInvalidPayoffs(payoffs, size);
+		return;
+	}
+	long_call.calculatePayoff(spot_prices, payoffs, size);
+	short_call.accumulatePayoff(-1.0, spot_prices, payoffs, size);
+}
+
+void CalculateStrategy::getButterfly(const Option& wing1, const Option& body, const Option& wing2, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size,
+	PricingStatus& status) const noexcept
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	status = checkButterfly(wing1, body, wing2);
+	if (status != PricingStatus::Ok)
+	{
+		fillInvalidPayoffs(payoffs, size);
+		return;
+	}
+	wing1.calculatePayoff(spot_prices, payoffs, size);
+	body.accumulatePayoff(-2.0, spot_prices, payoffs, size);
+	wing2.accumulatePayoff(1.0, spot_prices, payoffs, size);
+}
+
+void CalculateStrategy::getStrangle(const Option& put, const Option& call, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size,
+	PricingStatus& status) const noexcept
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	status = checkStrangle(put, call);
+	if (status != PricingStatus::Ok)
+	{
+		fillInvalidPayoffs(payoffs, size);
+		return;
+	}
+	put.calculatePayoff(spot_prices, payoffs, size);
+	call.accumulatePayoff(1.0, spot_prices, payoffs, size);
+}
+
+void CalculateStrategy::getStraddle(const Option& put, const Option& call, const Price* spot_prices, StrategyPayoff* payoffs, const std::size_t size,
+	PricingStatus& status) const noexcept
+{
+	FC_METRICS_SCOPE(StrategyPayoff);
+	FC_METRICS_ITEMS(size);
+
+	status = checkStraddle(put, call);
+	if (status != PricingStatus::Ok)
+	{
+		fillInvalidPayoffs(payoffs, size);
+		return;
+	}
+	put.calculatePayoff(spot_prices, payoffs, size);
+	call.accumulatePayoff(1.0, spot_prices, payoffs, size);
+}
+
+// Strike checks shared by the throwing validations and the status returning grids (negated comparisons, NaN strikes fail)
+
+[[nodiscard]] PricingStatus CalculateStrategy::checkPutSpread(const Option& long_put, const Option& short_put) noexcept
+{
+	return long_put.getStrike() > short_put.getStrike() ? PricingStatus::Ok : PricingStatus::InvalidStrikes;
+}
+
+[[nodiscard]] PricingStatus CalculateStrategy::checkCallSpread(const Option& long_call, const Option& short_call) noexcept
+{
+	return long_call.getStrike() < short_call.getStrike() ? PricingStatus::Ok : PricingStatus::InvalidStrikes;
+}
+
+[[nodiscard]] PricingStatus CalculateStrategy::checkButterfly(const Option& wing1, const Option& body, const Option& wing2) noexcept
+{
+	return wing1.getStrike() < body.getStrike() && body.getStrike() < wing2.getStrike() ? PricingStatus::Ok : PricingStatus::InvalidStrikes;
+}
+
+[[nodiscard]] PricingStatus CalculateStrategy::checkStrangle(const Option& put, const Option& call) noexcept
+{
+	return put.getStrike() < call.getStrike() ? PricingStatus::Ok : PricingStatus::InvalidStrikes;
+}
+
+[[nodiscard]] PricingStatus CalculateStrategy::checkStraddle(const Option& put, const Option& call) noexcept
+{
+	return put.getStrike() == call.getStrike() ? PricingStatus::Ok : PricingStatus::InvalidStrikes;
+}
+
+[[nodiscard]] PricingStatus CalculateStrategy::checkIronCondor(const Option& long_put, const Option& short_put, const Option& short_call, const Option& long_call) noexcept
+{
+	if (long_put.getType() != OptionType::Put || short_put.getType() != OptionType::Put || short_call.getType() != OptionType::Call || long_call.getType() != OptionType::Call)
+	{
+		return PricingStatus::InvalidOptionType;
+	}
+	return long_put.getStrike() < short_put.getStrike() && short_put.getStrike() < short_call.getStrike() && short_call.getStrike() < long_call.getStrike()
+		? PricingStatus::Ok : PricingStatus::InvalidStrikes;
+}
+
+void CalculateStrategy::validatePutSpread(const Option& long_put, const Option& short_put)
+{
+	if (checkPutSpread(long_put, short_put) != PricingStatus::Ok)
+	{
+		throw std::runtime_error("[!] Long put strike should be higher than short put strike");
+	}
+}
+
+void CalculateStrategy::validateCallSpread(const Option& long_call, const Option& short_call)
+{
+	if (checkCallSpread(long_call, short_call) != PricingStatus::Ok)
+	{
+		throw std::runtime_error("[!] Long call strike should be lower than short call strike");
+	}
+}
+
+void CalculateStrategy::validateButterfly(const Option& wing1, const Option& body, const Option& wing2)
+{
+	if (checkButterfly(wing1, body, wing2) != PricingStatus::Ok)
+	{
+		throw std::runtime_error("[!] Strikes should be in ascending order");
+	}
+}
+
+void CalculateStrategy::validateStrangle(const Option& put, const Option& call)
+{
+	if (checkStrangle(put, call) != PricingStatus::Ok)
+	{
+		throw std::runtime_error("[!] Put strike should be lower than Call strike");
+	}
+}
+
+void CalculateStrategy::validateStraddle(const Option& put, const Option& call)
+{
+	if (checkStraddle(put, call) != PricingStatus::Ok)
+	{
+		throw std::runtime_error("For Straddle, Put and Call strikes should be the same");
+	}
+}
+
+void CalculateStrategy::validateIronCondor(const Option& long_put, const Option& short_put, const Option& short_call, const Option& long_call)
+{
+	switch (checkIronCondor(long_put, short_put, short_call, long_call))
+	{
+	case PricingStatus::Ok:
+		return;
+	case PricingStatus::InvalidOptionType:
+		throw std::runtime_error("[!] An iron condor is made of two puts followed by two calls");
+	default:
+		throw std::runtime_error("[!] Strikes should be in ascending order");
+	}
 }
@@ -1,8 +1,19 @@
 ﻿#pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
-#include <random>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include "random.h"
+#include "pricing_control.h"
+#include "scratch_arena.h"
+#include "task_scheduler.h"
 
 constexpr const double MATH_PI = 3.14159265358979323846;
 
@@ -36,12 +47,27 @@ enum class Greeks
 *	Rho (ρ) is positive for calls and negative for puts
 */
 
-enum class OptionType
+// One byte so a column of option types on disk maps directly onto OptionChain::option_type
+enum class OptionType : std::uint8_t
 {
 	Call,
 	Put
 };
 
+// Outcome of the validation of one contract (or strategy) by the status returning pricers, the exception free path of the batch loops
+enum class PricingStatus : std::uint8_t
+{
+	Ok,
+	InvalidOptionType,	// Neither Call nor Put
+	NonPositiveTime,
+	NonPositiveVolatility,
+	NonPositivePrice,	// Underlying or strike price
+	InvalidStrikes,		// Strikes (or option types) of a strategy in the wrong order
+};
+
+// @pricingStatusMessage : Message of the exception the throwing pricers raise for the same input
+[[nodiscard]] const char* pricingStatusMessage(PricingStatus status) noexcept;
+
 // Aliases for better readability
 using Price = double;
 using Time = double;
@@ -52,6 +78,18 @@ using StrategyPayoff = double;
 using DividendYield = double;
 using Volatility = double;
 
+// @normalCdf : Calculates the cumulative distribution function (CDF) of the standard normal distribution (median 0 and variance 1)
+[[nodiscard]] inline double normalCdf(double x) noexcept
+{
+	return 0.5 * std::erfc(-x / std::sqrt(2.0));
+}
+
+// @normalPdf : Calculates the probability density function (PDF) of the standard normal distribution
+[[nodiscard]] inline double normalPdf(double x) noexcept
+{
+	return (1.0 / std::sqrt(2.0 * MATH_PI)) * std::exp(-0.5 * x * x);
+}
+
 // Struct to hold the parameters needed for the Black-Scholes calculations
 struct BlackScholesParams
 {
@@ -86,10 +124,62 @@ struct GreeksParams
 									per year and the stock price is 100$, then the dividend yield is (1/100) * 100*/
 };
 
+// Variance reduction techniques available for the Monte Carlo calculations
+enum class VarianceReduction
+{
+	None,		// Plain Monte Carlo
+	Antithetic,	// Every normal draw Z also drives a mirrored path with -Z, each sample is the average payoff of the pair
+	ControlVariate,	// The terminal price of the path is the control of European payoffs, the European payoff (priced by calculateBlackScholes) the one of path-dependent payoffs
+};
+
+// How the Monte Carlo paths are discretized in time
+enum class SimulationMode
+{
+	DailySteps,	// One GBM step per day of the option's life (needed by path-dependent payoffs)
+	TerminalOnly,	// A single exact GBM step up to expiration, enough for path-independent (European) payoffs
+};
+
+// Where the normal draws of the Monte Carlo paths come from
+enum class SamplingMethod
+{
+	PseudoRandom,		// Independent draws of random_engine (Box-Muller), error O(1/sqrt(N))
+	Sobol,			// Sobol low-discrepancy points with a Brownian bridge over the steps, close to O(1/N) for smooth payoffs but no error estimate
+	RandomizedSobol,	// qmc_replicates independently digitally shifted Sobol point sets, their spread gives the standard error
+};
+
+/*
+	Payoff of the Monte Carlo paths, the path-dependent ones keep a running statistic of every path inside the step loop (no path is stored)
+	and are monitored once per step (discretely, daily), they need SimulationMode::DailySteps
+	-.Asian : fixed strike on the arithmetic average of the prices at every step
+	-.Barriers : the vanilla payoff, knocked out (0) / knocked in once a step price crosses the barrier (up: S >= barrier, down: S <= barrier),
+	a spot already beyond the barrier counts as a crossing. Knock-out paths stop being simulated once they are out (see simulatePayoffs).
+	-.Lookbacks : fixed strike on the running maximum (call) / minimum (put), or floating strike S_T - minimum (call) / maximum - S_T (put),
+	the extremes include the spot
+*/
+enum class PathPayoff
+{
+	European,
+	Asian,
+	UpAndOut,
+	UpAndIn,
+	DownAndOut,
+	DownAndIn,
+	LookbackFixedStrike,
+	LookbackFloatingStrike,
+};
+
+// One asset of a multi-asset (basket / spread) Monte Carlo, its GBM shares the interest rate and the time of the params
+struct BasketAsset
+{
+	Price underlying_price{};
+	Volatility volatility{};
+	double weight{ 1.0 };	// Weight in the basket value Σ w_i S_i (e.g. 1 and -1 for a spread)
+};
+
 // Struct to hold the parameters needed for the Monte Carlo calculations
 struct MonteCarloParams
 {
-	std::size_t number_of_simulations{};
+	std::size_t number_of_simulations{};	// Paths to simulate (progressive mode: most paths to simulate, 0 means no limit)
 	InterestRate interest_rate{};	
 	Price underlying_price{};      
 	Price strike_price{};          
@@ -97,44 +187,326 @@ struct MonteCarloParams
 	Volatility volatility{};
 	OptionType option_type{}; 
 	Price paid_price{};
+	std::size_t number_of_threads{ 1 };	// Worker threads the paths are split across (0 uses every hardware thread available)
+	std::uint64_t seed{ 0 };		// Base seed of the random streams, each worker derives its own stream from it (0 draws a fresh, non reproducible seed)
+	VarianceReduction variance_reduction{ VarianceReduction::None };
+	SimulationMode simulation_mode{ SimulationMode::DailySteps };
+	RandomEngine random_engine{ RandomEngine::MersenneTwister };
+	SamplingMethod sampling_method{ SamplingMethod::PseudoRandom };
+	std::size_t qmc_replicates{ 16 };	// Randomized Sobol only: the paths are split into this many replicates (use a power of two paths per replicate)
+	PathPayoff path_payoff{ PathPayoff::European };
+	Price barrier{};			// Barrier payoffs only: level of the barrier
+	Price target_standard_error{};		// Progressive mode: stop once the standard error of the estimate is at most this, after at least 65536 samples (0 means no target)
+	double time_budget{};			// Progressive mode: stop once about this many seconds have been spent simulating (0 means no budget)
+
+	/*
+		Multi-asset mode (assets not empty): the paths move correlated GBMs of every asset and the payoff (path_payoff included, with
+		its running statistic and barrier) is taken on the basket value Σ w_i S_i, underlying_price and volatility are not read
+		-.correlation is the assets x assets correlation matrix, row-major (empty means independent assets), it must be symmetric
+		positive semi-definite with a unit diagonal
+		-.Pseudo-random sampling only, no control variate (antithetic pairs mirror the correlated draws)
+	*/
+	std::vector<BasketAsset> assets{};
+	std::vector<double> correlation{};
 };
 
-// Small class used to generate values under certain type (only numeric values allowed) and bound constraints
-template<typename RandomType>
-class RandomGenerator
+// Struct holding a Monte Carlo estimate together with its accuracy
+struct MonteCarloResult
 {
-private:
-	std::random_device rd{};
-	std::mt19937_64 gen{ rd() };
+	Price price{};			// Discounted estimate of the option price
+	Price standard_error{};		// Standard error of the estimate (same units as the price)
+	std::size_t number_of_paths{};	// Simulated paths (an antithetic pair counts as two)
+	bool target_reached{};		// Progressive mode: the run stopped on target_standard_error (not on the path limit or the time budget)
+	// (plain Sobol sampling has no error estimate, its standard_error is NaN)
+};
 
-	static_assert(std::is_arithmetic_v<RandomType>, "[!] The type must be a numeric type");
-	typename std::conditional<std::is_floating_point_v<RandomType>,
-		std::uniform_real_distribution<RandomType>,
-		std::uniform_int_distribution<RandomType>>::type distribution;
+// Running sums accumulated by every Monte Carlo worker, they are additive so the partial results of the workers are simply merged
+struct PayoffStatistics
+{
+	double sum{};			// Σ Y   : Undiscounted payoffs of the samples
+	double sum_squares{};		// Σ Y²
+	double control_sum{};		// Σ X   : Undiscounted payoffs of the control (ControlVariate only)
+	double control_sum_squares{};	// Σ X²
+	double cross_sum{};		// Σ X·Y
+	std::size_t samples{};
 
-public:
-	RandomGenerator(const RandomType left_limit, const RandomType right_limit) noexcept
-		: distribution(std::min(left_limit, right_limit), std::max(left_limit, right_limit)) {}
+	PayoffStatistics& operator+=(const PayoffStatistics& other) noexcept
+	{
+		sum += other.sum;
+		sum_squares += other.sum_squares;
+		control_sum += other.control_sum;
+		control_sum_squares += other.control_sum_squares;
+		cross_sum += other.cross_sum;
+		samples += other.samples;
+		return *this;
+	}
+};
+
+/*
+	Struct-of-arrays view over an option chain (the calculator never owns these buffers)
+	-.Every column points to `size` contiguous elements, element i of every column describes the i-th contract of the chain
+	-.Keeping each field in its own contiguous array lets the batch pricers stream through memory and vectorize the math
+*/
+struct OptionChain
+{
+	const Price* underlying_price{};
+	const Price* strike_price{};
+	const Time* time{};
+	const Volatility* volatility{};
+	const InterestRate* interest_rate{};
+	const OptionType* option_type{};
+	const DividendYield* dividend_yield{};	// Optional column, only read by the Greeks pricers (nullptr means no dividends)
+	std::size_t size{};
+};
+
+// Struct holding the price and every greek of one option, all of them computed from a single evaluation of d1, d2 and the discounts
+struct OptionGreeks
+{
+	Price price{};
+	double delta{};
+	double gamma{};
+	double theta{};
+	double vega{};
+	double rho{};
+};
+
+// Struct-of-arrays output of the batch Greeks pricer, every column must point to at least `size` writable elements of the priced chain
+struct OptionGreeksChain
+{
+	Price* price{};
+	double* delta{};
+	double* gamma{};
+	double* theta{};
+	double* vega{};
+	double* rho{};
+};
+
+// @intrinsicValue : Payoff at expiration of a Call / Put known at compile time, max(S - K, 0) or max(K - S, 0)
+template<OptionType Type>
+[[nodiscard]] constexpr Price intrinsicValue(const Price underlying_price, const Price strike_price) noexcept
+{
+	if constexpr (Type == OptionType::Call) return std::max(underlying_price - strike_price, 0.0);
+	else return std::max(strike_price - underlying_price, 0.0);
+}
 
-	[[nodiscard]] inline RandomType getRandomValue() noexcept { return distribution(gen); }
+// Hardware the Monte Carlo and batch closed form pricers of a FinancialCalculator run on
+enum class ComputeBackend
+{
+	Cpu,	// SIMD kernels and worker threads
+	Gpu,	// CUDA backend of gpu_backend.h when compiled in and a device is present, the CPU path otherwise (and for what it doesn't cover)
 };
 
+class SobolSequence;
+class BrownianBridge;
+
+// Paths simulated together by one Monte Carlo worker (their prices, normals and uniforms stay in L1)
+constexpr std::size_t MONTE_CARLO_BLOCK_SIZE = 256;
+
+// Samples of one task of a submitted Monte Carlo job, also its stream / Sobol index range, so the result doesn't depend on the worker count
+constexpr std::size_t MONTE_CARLO_TASK_SAMPLES = 16 * MONTE_CARLO_BLOCK_SIZE;
+
+// Contracts of one task of an asynchronous chain request
+constexpr std::size_t CHAIN_TASK_SIZE = 8192;
+
+// @monteCarloSteps : GBM steps of every path (a single one of Δt = T in terminal-only mode, and at least one under a day to maturity)
+[[nodiscard]] inline std::size_t monteCarloSteps(const MonteCarloParams& params) noexcept
+{
+	return params.simulation_mode == SimulationMode::TerminalOnly ? 1 : std::max<std::size_t>(1, static_cast<std::size_t>(params.time * 365.0));
+}
+
+/*
+	FinancialCalculator : Stateless pricers, the scratch arrays of a call (Monte Carlo paths, normals, uniforms, Sobol tables...) are
+	allocated from a memory resource instead of the global heap
+	-.By default the resource is the scratch arena of the calling thread, so the steady state of repeated calls allocates nothing
+	-.A caller provided resource must outlive the calculator, and be thread safe (e.g. std::pmr::synchronized_pool_resource) when the
+	same calculator is used from several threads at once. Monte Carlo allocates the scratch of all its workers up front on the calling thread.
+	-.The closed form and batch chain pricers need no scratch at all
+	-.The submit* pricers run on a TaskScheduler (TaskScheduler::shared() by default, a caller provided one must outlive the calculator
+	and its pending jobs), their scratch always comes from the arena of the worker
+*/
 class FinancialCalculator
 {
+private:
+	struct SubmissionBatches;	// Closed form jobs waiting for their batch task, shared by the copies of a calculator
+
+	std::pmr::memory_resource* scratch_resource_{};	// nullptr means threadScratchArena()
+	TaskScheduler* scheduler_{};			// nullptr means TaskScheduler::shared()
+	std::shared_ptr<SubmissionBatches> batches_{};	// nullptr means the batches of the shared scheduler
+	ComputeBackend compute_backend_{ ComputeBackend::Cpu };
+
 public:
 	FinancialCalculator() = default;
+	explicit FinancialCalculator(std::pmr::memory_resource* scratch_resource) noexcept : scratch_resource_(scratch_resource) {}
+	explicit FinancialCalculator(TaskScheduler& scheduler, std::pmr::memory_resource* scratch_resource = nullptr);
+
+	[[nodiscard]] inline std::pmr::memory_resource* getScratchResource() const noexcept { return scratch_resource_ != nullptr ? scratch_resource_ : &threadScratchArena(); }
+	[[nodiscard]] inline TaskScheduler& getScheduler() const { return scheduler_ != nullptr ? *scheduler_ : TaskScheduler::shared(); }
+
+	/*
+		@setComputeBackend: ComputeBackend::Gpu sends the work the device backend covers there, behind the same API
+		-.Pseudo-random Monte Carlo (not progressive), synchronous or submitted as one device task, the estimate comes from the device's
+		own random streams (reproducible for a fixed seed, but not equal to the CPU estimate)
+		-.Batch Black-Scholes and Greeks of chains of at least GPU_MIN_CHAIN_SIZE contracts, validated on the host as usual: an
+		asynchronous chain that large is priced by a single task, submitted closed forms are batched by GPU_MIN_CHAIN_SIZE jobs
+		-.Everything else, and any call the device fails, runs on the CPU
+	*/
+	inline FinancialCalculator& setComputeBackend(const ComputeBackend compute_backend) noexcept { compute_backend_ = compute_backend; return *this; }
+	[[nodiscard]] inline ComputeBackend getComputeBackend() const noexcept { return compute_backend_; }
 
 	[[nodiscard]] Price calculateBlackScholes(const BlackScholesParams& params) const;
-	[[nodiscard]] inline double calculateFutures(const FuturesParams& params) const;
+	void calculateBlackScholes(const OptionChain& chain, Price* prices) const;
+	[[nodiscard]] Price calculateBlackScholesApproximate(const BlackScholesParams& params) const;
+	[[nodiscard]] inline double calculateFutures(const FuturesParams& params) const noexcept { return params.present_value * std::pow(1 + params.interest_rate, params.time); }
 	[[nodiscard]] Price calculateGreeks(const GreeksParams& params, const Greeks greek) const;
+	[[nodiscard]] OptionGreeks calculateGreeks(const GreeksParams& params) const;
+	void calculateGreeks(const OptionChain& chain, const OptionGreeksChain& greeks) const;
+	[[nodiscard]] Volatility calculateImpliedVolatility(const BlackScholesParams& params) const;
+
+	/*
+		Specializations on the option type (and greek) for homogeneous workloads, the runtime overloads above dispatch to them
+		-.params.option_type is not read, the Call / Put branches are resolved at compile time
+		-.Instantiated for OptionType::Call / OptionType::Put and every Greeks value
+	*/
+	template<OptionType Type>
+	[[nodiscard]] Price calculateBlackScholes(const BlackScholesParams& params) const noexcept;
+	template<Greeks Greek, OptionType Type>
+	[[nodiscard]] double calculateGreeks(const GreeksParams& params) const;
+	template<OptionType Type>
+	[[nodiscard]] OptionGreeks calculateGreeks(const GreeksParams& params) const;
+
+	void calculateImpliedVolatility(const OptionChain& chain, const Price* paid_prices, Volatility* volatilities) const;
+
+	/*
+		Exception free batch pricers: a bad contract doesn't abort the chain, the whole chain is still priced by the same kernels
+		-.A branch-free pass writes statuses[i] for every contract (positive spot, strike, time and volatility, Call / Put, NaN fails
+		too), the kernel then prices the whole chain and only the contracts whose status isn't Ok get NaN outputs
+		-.statuses must point to at least chain.size elements, the number of invalid contracts is returned (0: nothing was overwritten)
+		-.For the implied volatilities the volatility column only holds the warm starts and isn't checked, quotes outside of their
+		no-arbitrage bounds keep their NaN volatility with an Ok status, like the throwing overload
+	*/
+	[[nodiscard]] std::size_t calculateBlackScholes(const OptionChain& chain, Price* prices, PricingStatus* statuses) const noexcept;
+	[[nodiscard]] std::size_t calculateGreeks(const OptionChain& chain, const OptionGreeksChain& greeks, PricingStatus* statuses) const noexcept;
+	[[nodiscard]] std::size_t calculateImpliedVolatility(const OptionChain& chain, const Price* paid_prices, Volatility* volatilities, PricingStatus* statuses) const noexcept;
+
 	[[nodiscard]] Price calculateMonteCarlo(const MonteCarloParams& params) const;
+	[[nodiscard]] MonteCarloResult calculateMonteCarloEstimate(const MonteCarloParams& params) const;
+
+	/*
+		Asynchronous pricers, the job runs on the scheduler and its result (or the exception of an invalid job) is delivered by the future
+		-.Closed forms are queued and priced together: the first job of an empty queue schedules one task that prices everything queued
+		until it runs through the batch chain kernels, so a burst of small jobs costs a few vectorized batches instead of a task each
+		-.Monte Carlo is split into tasks of MONTE_CARLO_TASK_SAMPLES samples that idle workers steal, the last one to finish merges
+		the partial statistics in task order: for a fixed seed the estimate only depends on the parameters (params.number_of_threads is
+		ignored), not on the number of workers or the order the tasks ran in
+	*/
+	[[nodiscard]] std::future<Price> submitBlackScholes(const BlackScholesParams& params) const;
+	[[nodiscard]] std::future<OptionGreeks> submitGreeks(const GreeksParams& params) const;
+	[[nodiscard]] std::future<MonteCarloResult> submitMonteCarlo(const MonteCarloParams& params) const;
+
+	/*
+		Callback pricers for non-blocking callers (pricing_awaitable.h wraps them into C++20 awaitables), they return right away
+		-.The callback runs once on a worker thread when the request completes, fails (invalid params, PricingCancelled) or is skipped,
+		it must not throw nor block on the result of another task
+		-.control cancels the request or bounds it by a deadline, it is checked before every task
+		-.Monte Carlo runs the tasks of submitMonteCarlo (same estimate for the same seed), chains are priced by slices of CHAIN_TASK_SIZE
+		contracts (the whole chain when the GPU backend takes it), every slice validated like the synchronous batch pricer: the chain
+		columns and the outputs must stay alive until the callback
+	*/
+	void calculateMonteCarloAsync(const MonteCarloParams& params, PricingCallback<MonteCarloResult> callback, const PricingControl& control = {}) const;
+	void calculateBlackScholesAsync(const OptionChain& chain, Price* prices, ChainPricingCallback callback, const PricingControl& control = {}) const;
+	void calculateGreeksAsync(const OptionChain& chain, const OptionGreeksChain& greeks, ChainPricingCallback callback, const PricingControl& control = {}) const;
+
+private:
+	[[nodiscard]] PayoffStatistics runMonteCarloWorkers(const MonteCarloParams& params, std::size_t number_of_samples, std::uint64_t seed, const SobolSequence* sobol_sequence, const BrownianBridge* brownian_bridge) const;
+	void runMonteCarloChunks(const MonteCarloParams& params, std::uint64_t seed, std::size_t first_chunk, std::size_t chunks, std::size_t sample_limit, std::size_t replicates,
+		std::size_t number_of_threads, const SobolSequence* sobol_sequence, const BrownianBridge* brownian_bridge, PayoffStatistics* statistics) const;
+	[[nodiscard]] PayoffStatistics simulateSamples(const MonteCarloParams& params, std::size_t number_of_samples, std::uint64_t seed, std::uint64_t stream,
+		SobolSequence* sobol_sequence, std::uint64_t first_index, const BrownianBridge* brownian_bridge, double* scratch) const;
+	[[nodiscard]] std::shared_ptr<SubmissionBatches> submissionBatches() const;
+	void priceChainBlackScholes(const OptionChain& chain, Price* prices) const noexcept;
+	void priceChainGreeks(const OptionChain& chain, const OptionGreeksChain& greeks) const noexcept;
+
+	template<OptionType Type, typename NormalSource>
+	[[nodiscard]] PayoffStatistics simulatePayoffs(const MonteCarloParams& params, std::size_t number_of_samples, NormalSource& normal_source, double* path_scratch) const;
 };
 
-// @normalCdf : Calculates the cumulative distribution function (CDF) of the standard normal distribution (median 0 and variance 1)
-[[nodiscard]] inline double normalCdf(double x) noexcept;
+/*
+	Option whose spot independent Black-Scholes terms are computed once (ln K, σ√T, the drift of d1, K * e^(-rT), e^(-qT)...)
+	-.reprice(spot) then costs one log, two CDFs and a few multiplications, repriceGreeks(spot) adds one PDF
+	-.Built from BlackScholesParams there are no dividends and reprice matches calculateBlackScholes, built from GreeksParams
+	repriceGreeks matches calculateGreeks (and reprice is its price)
+	-.The constructor validates the inputs (positive time and volatility, Call / Put), repricing never throws
+*/
+class PreparedOption
+{
+private:
+	double sign_{};			// +1 for calls, -1 for puts
+	double log_strike_{};		// ln K
+	double drift_{};		// (r + σ² / 2) * T
+	double inverse_volatility_sqrt_time_{};
+	double volatility_sqrt_time_{};	// σ√T
+	double sqrt_time_{};
+	double strike_discount_{};	// K * e^(-rT)
+	double dividend_discount_{};	// e^(-qT)
+	Time time_{};
+	Volatility volatility_{};
+	InterestRate interest_rate_{};
+	DividendYield dividend_yield_{};
 
-// @normalPdf : Calculates the probability density function (PDF) of the standard normal distribution
-[[nodiscard]] inline double normalPdf(double x) noexcept;
+public:
+	explicit PreparedOption(const BlackScholesParams& params);
+	explicit PreparedOption(const GreeksParams& params);
+
+	[[nodiscard]] Price reprice(Price spot) const noexcept;
+	[[nodiscard]] OptionGreeks repriceGreeks(Price spot) const noexcept;
+};
+
+/*
+	Chain counterpart of PreparedOption, for ticks moving the single underlying of a whole chain
+	-.The spot independent terms of every contract are kept in contiguous columns, the underlying_price column of the chain is ignored
+	-.The dividend_yield column is honoured like in calculateGreeks (nullptr means no dividends, reprice then matches calculateBlackScholes)
+	-.Repricing runs the vectorized CDF / PDF kernels of simd.h over scratch columns owned by the object, so an instance
+	must not be repriced from several threads at once
+	-.Every column (the scratch ones included) is allocated from the memory resource given at construction
+*/
+class PreparedOptionChain
+{
+private:
+	std::pmr::vector<double> sign_{};
+	std::pmr::vector<double> log_strike_minus_drift_{};	// ln K - (r + σ² / 2) * T
+	std::pmr::vector<double> inverse_volatility_sqrt_time_{};
+	std::pmr::vector<double> volatility_sqrt_time_{};
+	std::pmr::vector<double> sqrt_time_{};
+	std::pmr::vector<double> strike_discount_{};
+	std::pmr::vector<double> dividend_discount_{};
+	std::pmr::vector<double> time_{};
+	std::pmr::vector<double> volatility_{};
+	std::pmr::vector<double> interest_rate_{};
+	std::pmr::vector<double> dividend_yield_{};
+
+	// Scratch columns of reprice / repriceGreeks
+	std::pmr::vector<double> d1_{};
+	std::pmr::vector<double> cdf_d1_{};
+	std::pmr::vector<double> cdf_d2_{};
+	std::pmr::vector<double> pdf_d1_{};
+
+	void evaluateDistributions(Price spot, bool with_pdf) noexcept;
+
+public:
+	explicit PreparedOptionChain(const OptionChain& chain, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return sign_.size(); }
+
+	// @reprice : prices[i] = price of contract i with the underlying at spot, prices must point to at least size() elements
+	void reprice(Price spot, Price* prices) noexcept;
+
+	// @repriceGreeks : Price and Greeks of every contract with the underlying at spot (same values as calculateGreeks)
+	void repriceGreeks(Price spot, const OptionGreeksChain& greeks) noexcept;
+};
+
+
+// @inverseNormalCdf : Quantile function of the standard normal distribution, p must lie in (0, 1)
+[[nodiscard]] double inverseNormalCdf(double p) noexcept;
 
 class Option
 {
@@ -145,21 +517,105 @@ private:
 public:
 	Option(Price strike, Price premium, OptionType type);
 
-	[[nodiscard]] inline Price calculatePayoff(Price spotPrice) const;
+	[[nodiscard]] Price calculatePayoff(Price spotPrice) const;
+	void calculatePayoff(const Price* spot_prices, Price* payoffs, std::size_t size) const noexcept;
+	void accumulatePayoff(double quantity, const Price* spot_prices, Price* payoffs, std::size_t size) const noexcept;
 
 	[[nodiscard]] inline Price getStrike() const noexcept { return strike_; }
 	[[nodiscard]] inline Price getPremium()  const noexcept { return premium_; }
 	[[nodiscard]] inline OptionType getType() const noexcept { return option_type_; }
 };
 
+// One leg of a multi-leg strategy, a positive quantity is a long position and a negative one a short position
+struct StrategyLeg
+{
+	Option option;
+	double quantity{};
+};
+
+// Market every leg of a multi-leg strategy is valued in (the legs share the underlying and the expiration)
+struct StrategyMarket
+{
+	InterestRate interest_rate{};
+	Price underlying_price{};
+	Time time{};
+	Volatility volatility{};
+	DividendYield dividend_yield{};
+};
+
+/*
+	Strategy made of any number of legs with signed quantities (condors, ratio spreads, custom structures...)
+	-.The legs are kept in one flat contiguous array, so every calculation is a single pass over it
+	-.Payoffs include the premiums (quantity * (payoff - premium) summed over the legs), the Black-Scholes value does not
+	-.calculateGreeks returns the value and every greek of the whole structure (Σ quantity * leg greek), the terms shared by the legs
+	(√T, the discounts, ln S) are evaluated once per call instead of once per leg
+*/
+class MultiLegStrategy
+{
+private:
+	std::vector<StrategyLeg> legs_{};
+public:
+	MultiLegStrategy() = default;
+	explicit MultiLegStrategy(std::vector<StrategyLeg> legs);
+
+	MultiLegStrategy& addLeg(const Option& option, double quantity);
+
+	[[nodiscard]] inline const std::vector<StrategyLeg>& getLegs() const noexcept { return legs_; }
+	[[nodiscard]] inline std::size_t size() const noexcept { return legs_.size(); }
+
+	[[nodiscard]] Price getNetPremium() const noexcept;
+	[[nodiscard]] StrategyPayoff calculatePayoff(Price spotPrice) const noexcept;
+	void calculatePayoff(const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size) const noexcept;
+	[[nodiscard]] Price calculateBlackScholes(const StrategyMarket& market) const;
+	[[nodiscard]] OptionGreeks calculateGreeks(const StrategyMarket& market) const;
+};
+
 class CalculateStrategy
 {
 public:
 	CalculateStrategy() = default;
 
-	[[nodiscard]] inline StrategyPayoff getPutSpread(const Option& long_put, const Option& short_put, Price spotPrice) const;
-	[[nodiscard]] inline StrategyPayoff getCallSpread(const Option& long_call, const Option& short_call, Price spotPrice) const;
-	[[nodiscard]] inline StrategyPayoff getButterfly(const Option& wing1, const Option& body, const Option& wing2, Price spotPrice) const;
-	[[nodiscard]] inline StrategyPayoff getStrangle(const Option& put, const Option& call, Price spotPrice) const;
-	[[nodiscard]] inline StrategyPayoff getStraddle(const Option& put, const Option& call, Price spotPrice) const;
+	// The fixed strategies as multi-leg structures (same strike checks as the getters below)
+	[[nodiscard]] static MultiLegStrategy makePutSpread(const Option& long_put, const Option& short_put);
+	[[nodiscard]] static MultiLegStrategy makeCallSpread(const Option& long_call, const Option& short_call);
+	[[nodiscard]] static MultiLegStrategy makeButterfly(const Option& wing1, const Option& body, const Option& wing2);
+	[[nodiscard]] static MultiLegStrategy makeStrangle(const Option& put, const Option& call);
+	[[nodiscard]] static MultiLegStrategy makeStraddle(const Option& put, const Option& call);
+	[[nodiscard]] static MultiLegStrategy makeIronCondor(const Option& long_put, const Option& short_put, const Option& short_call, const Option& long_call);
+
+	[[nodiscard]] StrategyPayoff getPutSpread(const Option& long_put, const Option& short_put, Price spotPrice) const;
+	[[nodiscard]] StrategyPayoff getCallSpread(const Option& long_call, const Option& short_call, Price spotPrice) const;
+	[[nodiscard]] StrategyPayoff getButterfly(const Option& wing1, const Option& body, const Option& wing2, Price spotPrice) const;
+	[[nodiscard]] StrategyPayoff getStrangle(const Option& put, const Option& call, Price spotPrice) const;
+	[[nodiscard]] StrategyPayoff getStraddle(const Option& put, const Option& call, Price spotPrice) const;
+
+	// Payoff grids: the strikes are validated once, then the strategy is evaluated at every spot_prices[i] into payoffs[i] for i in [0, size)
+	void getPutSpread(const Option& long_put, const Option& short_put, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size) const;
+	void getCallSpread(const Option& long_call, const Option& short_call, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size) const;
+	void getButterfly(const Option& wing1, const Option& body, const Option& wing2, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size) const;
+	void getStrangle(const Option& put, const Option& call, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size) const;
+	void getStraddle(const Option& put, const Option& call, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size) const;
+
+	// Exception free payoff grids: the strikes are checked into status, invalid strategies fill payoffs with NaN instead of throwing
+	void getPutSpread(const Option& long_put, const Option& short_put, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size, PricingStatus& status) const noexcept;
+	void getCallSpread(const Option& long_call, const Option& short_call, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size, PricingStatus& status) const noexcept;
+	void getButterfly(const Option& wing1, const Option& body, const Option& wing2, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size, PricingStatus& status) const noexcept;
+	void getStrangle(const Option& put, const Option& call, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size, PricingStatus& status) const noexcept;
+	void getStraddle(const Option& put, const Option& call, const Price* spot_prices, StrategyPayoff* payoffs, std::size_t size, PricingStatus& status) const noexcept;
+
+	// Strike checks of the strategies (Ok or InvalidStrikes, InvalidOptionType for an iron condor not made of two puts then two calls), e.g. to screen a batch of strategies up front
+	[[nodiscard]] static PricingStatus checkPutSpread(const Option& long_put, const Option& short_put) noexcept;
+	[[nodiscard]] static PricingStatus checkCallSpread(const Option& long_call, const Option& short_call) noexcept;
+	[[nodiscard]] static PricingStatus checkButterfly(const Option& wing1, const Option& body, const Option& wing2) noexcept;
+	[[nodiscard]] static PricingStatus checkStrangle(const Option& put, const Option& call) noexcept;
+	[[nodiscard]] static PricingStatus checkStraddle(const Option& put, const Option& call) noexcept;
+	[[nodiscard]] static PricingStatus checkIronCondor(const Option& long_put, const Option& short_put, const Option& short_call, const Option& long_call) noexcept;
+
+private:
+	static void validatePutSpread(const Option& long_put, const Option& short_put);
+	static void validateCallSpread(const Option& long_call, const Option& short_call);
+	static void validateButterfly(const Option& wing1, const Option& body, const Option& wing2);
+	static void validateStrangle(const Option& put, const Option& call);
+	static void validateStraddle(const Option& put, const Option& call);
+	static void validateIronCondor(const Option& long_put, const Option& short_put, const Option& short_call, const Option& long_call);
 };
@@ -0,0 +1,116 @@
+﻿#pragma once
+
+#include "options.h"
+
+/*
+*	C++20 awaitables over the callback pricers of FinancialCalculator, for coroutine based front ends (compiled out below C++20)
+*
+*	-.co_await suspends the coroutine without blocking its thread, the request runs on the scheduler of the calculator and the
+*	coroutine is resumed on the worker that completes it (hop back to an I/O executor from there if needed)
+*	-.co_await returns the result, or rethrows the error of the request (invalid params, PricingCancelled)
+*	-.A request completing before await_suspend returns (e.g. its tasks could not be scheduled) doesn't suspend the coroutine: the
+*	callback and await_suspend race on a flag, the second one to get there resumes (the callback) or continues (await_suspend)
+*	-.The awaited objects (params are copied, chain columns and outputs are not) must stay alive until the coroutine resumes
+*/
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+
+class MonteCarloAwaitable
+{
+public:
+	MonteCarloAwaitable(const FinancialCalculator& calculator, const MonteCarloParams& params, PricingControl control)
+		: calculator_(calculator), params_(params), control_(std::move(control)) {}
+
+	[[nodiscard]] bool await_ready() const noexcept { return false; }
+
+	[[nodiscard]] bool await_suspend(const std::coroutine_handle<> coroutine)
+	{
+		calculator_.calculateMonteCarloAsync(params_, [this, coroutine](const MonteCarloResult result, const std::exception_ptr error)
+		{
+			result_ = result;
+			error_ = error;
+			if (completed_.exchange(true, std::memory_order_acq_rel)) coroutine.resume();
+		}, control_);
+
+		// False when the callback already ran: the coroutine continues without being suspended
+		return !completed_.exchange(true, std::memory_order_acq_rel);
+	}
+
+	[[nodiscard]] MonteCarloResult await_resume() const
+	{
+		if (error_) std::rethrow_exception(error_);
+		return result_;
+	}
+
+private:
+	FinancialCalculator calculator_;
+	MonteCarloParams params_;
+	PricingControl control_;
+	MonteCarloResult result_{};
+	std::exception_ptr error_{};
+	std::atomic<bool> completed_{ false };	// Set by the first of the callback and await_suspend
+};
+
+// Chain request awaited in place: co_await completes once every price (or greek) of the chain is written
+class ChainAwaitable
+{
+public:
+	ChainAwaitable(const FinancialCalculator& calculator, const OptionChain& chain, Price* prices, PricingControl control)
+		: calculator_(calculator), chain_(chain), prices_(prices), control_(std::move(control)) {}
+	ChainAwaitable(const FinancialCalculator& calculator, const OptionChain& chain, const OptionGreeksChain& greeks, PricingControl control)
+		: calculator_(calculator), chain_(chain), greeks_(greeks), control_(std::move(control)) {}
+
+	[[nodiscard]] bool await_ready() const noexcept { return false; }
+
+	[[nodiscard]] bool await_suspend(const std::coroutine_handle<> coroutine)
+	{
+		auto resume = [this, coroutine](const std::exception_ptr error)
+		{
+			error_ = error;
+			if (completed_.exchange(true, std::memory_order_acq_rel)) coroutine.resume();
+		};
+
+		if (prices_ != nullptr) calculator_.calculateBlackScholesAsync(chain_, prices_, resume, control_);
+		else calculator_.calculateGreeksAsync(chain_, greeks_, resume, control_);
+
+		// False when the callback already ran: the coroutine continues without being suspended
+		return !completed_.exchange(true, std::memory_order_acq_rel);
+	}
+
+	void await_resume() const
+	{
+		if (error_) std::rethrow_exception(error_);
+	}
+
+private:
+	FinancialCalculator calculator_;
+	OptionChain chain_;
+	Price* prices_{};
+	OptionGreeksChain greeks_{};
+	PricingControl control_;
+	std::exception_ptr error_{};
+	std::atomic<bool> completed_{ false };
+};
+
+// @asyncMonteCarlo : co_await asyncMonteCarlo(calculator, params) gives the MonteCarloResult of calculateMonteCarloEstimate
+[[nodiscard]] inline MonteCarloAwaitable asyncMonteCarlo(const FinancialCalculator& calculator, const MonteCarloParams& params, PricingControl control = {})
+{
+	return MonteCarloAwaitable(calculator, params, std::move(control));
+}
+
+// @asyncBlackScholes : co_await asyncBlackScholes(calculator, chain, prices) prices the chain like the synchronous batch pricer
+[[nodiscard]] inline ChainAwaitable asyncBlackScholes(const FinancialCalculator& calculator, const OptionChain& chain, Price* prices, PricingControl control = {})
+{
+	return ChainAwaitable(calculator, chain, prices, std::move(control));
+}
+
+// @asyncGreeks : co_await asyncGreeks(calculator, chain, greeks) fills the Greeks columns like the synchronous batch pricer
+[[nodiscard]] inline ChainAwaitable asyncGreeks(const FinancialCalculator& calculator, const OptionChain& chain, const OptionGreeksChain& greeks, PricingControl control = {})
+{
+	return ChainAwaitable(calculator, chain, greeks, std::move(control));
+}
+
+#endif
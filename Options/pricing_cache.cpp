@@ -0,0 +1,181 @@
+﻿#include "pricing_cache.h"
+#include "metrics.h"
+
+#include <cstring>
+
+PricingCache::PricingCache(const PricingCacheConfig& config)
+	: config_(config)
+{
+	if (config_.capacity == 0) throw std::invalid_argument("[!] The cache capacity must be positive");
+	if (config_.shards == 0) throw std::invalid_argument("[!] The cache needs at least one shard");
+	if (config_.price_step < 0 || config_.time_step < 0 || config_.volatility_step < 0 || config_.rate_step < 0)
+	{
+		throw std::invalid_argument("[!] Quantization steps can't be negative");
+	}
+
+	config_.shards = std::min(config_.shards, config_.capacity);
+	shard_capacity_ = (config_.capacity + config_.shards - 1) / config_.shards;
+	shards_ = std::make_unique<Shard[]>(config_.shards);
+
+	// Keys are built with multiplications, a step of 0 keeps an inverse of 0
+	const auto inverse = [](const double step) { return step == 0.0 ? 0.0 : 1.0 / step; };
+	inverse_price_step_ = inverse(config_.price_step);
+	inverse_time_step_ = inverse(config_.time_step);
+	inverse_volatility_step_ = inverse(config_.volatility_step);
+	inverse_rate_step_ = inverse(config_.rate_step);
+}
+
+// @calculateBlackScholes : Cached FinancialCalculator::calculateBlackScholes (paid_price is not part of the key)
+[[nodiscard]] Price PricingCache::calculateBlackScholes(const BlackScholesParams& params)
+{
+	const GreeksParams inputs{ params.interest_rate, params.underlying_price, params.strike_price, params.time, params.volatility, params.option_type, params.paid_price, 0.0 };
+
+	return lookup(makeKey(inputs, false), [&]
+	{
+		OptionGreeks value;
+		value.price = calculator_.calculateBlackScholes(params);
+		return value;
+	}).price;
+}
+
+// @calculateGreeks : Cached FinancialCalculator::calculateGreeks of a single greek, served from the all-greeks entry of the contract
+[[nodiscard]] Price PricingCache::calculateGreeks(const GreeksParams& params, const Greeks greek)
+{
+	const OptionGreeks greeks = calculateGreeks(params);
+
+	switch (greek)
+	{
+	case Greeks::Delta: return greeks.delta;
+	case Greeks::Gamma: return greeks.gamma;
+	case Greeks::Theta: return greeks.theta;
+	case Greeks::Vega: return greeks.vega;
+	case Greeks::Rho: return greeks.rho;
+	default:
+		throw std::invalid_argument("[!] Invalid Greek specified");
+	}
+}
+
+// @calculateGreeks (all): Cached FinancialCalculator::calculateGreeks (paid_price is not part of the key)
+[[nodiscard]] OptionGreeks PricingCache::calculateGreeks(const GreeksParams& params)
+{
+	return lookup(makeKey(params, true), [&] { return calculator_.calculateGreeks(params); });
+}
+
+[[nodiscard]] PricingCacheStats PricingCache::getStats() const
+{
+	PricingCacheStats stats;
+	for (std::size_t i{ 0 }; i < config_.shards; ++i)
+	{
+		const std::lock_guard<std::mutex> lock(shards_[i].mutex);
+		stats.hits += shards_[i].hits;
+		stats.misses += shards_[i].misses;
+		stats.evictions += shards_[i].evictions;
+		stats.size += shards_[i].entries.size();
+	}
+	return stats;
+}
+
+// @clear : Drops every entry and resets the counters
+void PricingCache::clear()
+{
+	for (std::size_t i{ 0 }; i < config_.shards; ++i)
+	{
+		const std::lock_guard<std::mutex> lock(shards_[i].mutex);
+		shards_[i].entries.clear();
+		shards_[i].index.clear();
+		shards_[i].hits = shards_[i].misses = shards_[i].evictions = 0;
+	}
+}
+
+[[nodiscard]] std::size_t PricingCache::KeyHash::operator()(const Key& key) const noexcept
+{
+	return static_cast<std::size_t>(key.hash);
+}
+
+// @quantize : Index of the bucket holding value, inverse_step is 1 / step (with a step of 0, or out of range indices, the exact bits of value)
+[[nodiscard]] std::int64_t PricingCache::quantize(const double value, const double inverse_step) noexcept
+{
+	const double scaled = value * inverse_step;
+	if (inverse_step == 0.0 || !(std::fabs(scaled) < 0x1.0p62))
+	{
+		std::int64_t bits{};
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+	return static_cast<std::int64_t>(scaled + (scaled < 0.0 ? -0.5 : 0.5));	// Rounded half away from zero (the cast truncates)
+}
+
+[[nodiscard]] PricingCache::Key PricingCache::makeKey(const GreeksParams& params, const bool greeks) const noexcept
+{
+	Key key;
+	key.values = {
+		quantize(params.underlying_price, inverse_price_step_),
+		quantize(params.strike_price, inverse_price_step_),
+		quantize(params.time, inverse_time_step_),
+		quantize(params.volatility, inverse_volatility_step_),
+		quantize(params.interest_rate, inverse_rate_step_),
+		quantize(params.dividend_yield, inverse_rate_step_)
+	};
+	key.option_type = params.option_type;
+	key.greeks = greeks;
+
+	// Independent multiplications by odd constants, then a single splitmix64 round to spread them over every bit
+	constexpr std::uint64_t MULTIPLIERS[] = { 0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL, 0x94d049bb133111ebULL, 0xd6e8feb86659fd93ULL, 0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL };
+	std::uint64_t mixed = (static_cast<std::uint64_t>(key.option_type) << 1) | static_cast<std::uint64_t>(key.greeks);
+	for (std::size_t i{ 0 }; i < key.values.size(); ++i)
+	{
+		mixed += static_cast<std::uint64_t>(key.values[i]) * MULTIPLIERS[i];
+	}
+	key.hash = splitMix64(mixed);
+	return key;
+}
+
+[[nodiscard]] PricingCache::Shard& PricingCache::shardOf(const Key& key) const noexcept
+{
+	return shards_[(key.hash >> 32) % config_.shards];	// The high bits pick the shard, the low ones the bucket inside it
+}
+
+/*
+	@lookup : Value of key, computed (outside of the shard lock) and inserted on a miss
+	-.Two threads missing the same key at once both compute it, the second insertion just refreshes the entry
+	-.Inserting into a full shard evicts its least recently used entry
+*/
+template<typename Compute>
+[[nodiscard]] OptionGreeks PricingCache::lookup(const Key& key, Compute&& compute)
+{
+	Shard& shard = shardOf(key);
+	{
+		const std::lock_guard<std::mutex> lock(shard.mutex);
+		const auto found = shard.index.find(key);
+		if (found != shard.index.end())
+		{
+			++shard.hits;
+			FC_METRICS_COUNT(CacheHits, 1);
+			if (found->second != shard.entries.begin()) shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+			return found->second->second;
+		}
+		++shard.misses;
+	}
+	FC_METRICS_COUNT(CacheMisses, 1);
+
+	const OptionGreeks value = compute();
+
+	const std::lock_guard<std::mutex> lock(shard.mutex);
+	const auto found = shard.index.find(key);
+	if (found != shard.index.end())
+	{
+		found->second->second = value;
+		shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+		return value;
+	}
+
+	if (shard.entries.size() >= shard_capacity_)
+	{
+		shard.index.erase(shard.entries.back().first);
+		shard.entries.pop_back();
+		++shard.evictions;
+	}
+	shard.entries.emplace_front(key, value);
+	shard.index.emplace(key, shard.entries.begin());
+	return value;
+}
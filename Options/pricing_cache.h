@@ -0,0 +1,103 @@
+﻿#pragma once
+
+#include "options.h"
+
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/*
+*	Memoizing front of FinancialCalculator::calculateBlackScholes and calculateGreeks
+*
+*	-.The inputs that reach the formulas (S, K, T, σ, r, q and the option type) are quantized into a key, so repeated quotes of the
+*	same contract hit the cache even when fields the formulas ignore (paid_price) or tiny floating point noise differ
+*		-. Every quantity is rounded to a multiple of its step (a step of 0 keys on the exact bits of the value)
+*		-. On a miss the value is computed from the inputs of that call, later hits of the same bucket return it unchanged
+*	-.The cache is split into independently locked shards (picked by the hash of the key), every shard is an LRU list bounded to
+*	its share of the capacity, so threads only contend when they touch the same shard and there is no global lock
+*	-.Greeks entries hold the price and every greek (one pass of calculateGreeks), a single greek request reads it from the entry
+*	-.Inputs that make the calculator throw are never cached, the exception reaches the caller
+*/
+
+struct PricingCacheConfig
+{
+	std::size_t capacity{ 1 << 16 };	// Maximum number of cached entries (shared evenly by the shards, rounded up to a multiple of them)
+	std::size_t shards{ 16 };		// Independently locked parts of the cache
+	Price price_step{ 1e-6 };		// Quantization of the underlying and strike prices
+	Time time_step{ 1e-9 };			// Quantization of the time to expiration (years)
+	Volatility volatility_step{ 1e-9 };
+	InterestRate rate_step{ 1e-9 };		// Quantization of the interest rate and the dividend yield
+};
+
+// Counters of the cache since its creation (or the last clear)
+struct PricingCacheStats
+{
+	std::uint64_t hits{};
+	std::uint64_t misses{};
+	std::uint64_t evictions{};
+	std::size_t size{};		// Entries currently cached
+};
+
+class PricingCache
+{
+public:
+	explicit PricingCache(const PricingCacheConfig& config = {});
+
+	[[nodiscard]] Price calculateBlackScholes(const BlackScholesParams& params);
+	[[nodiscard]] Price calculateGreeks(const GreeksParams& params, Greeks greek);
+	[[nodiscard]] OptionGreeks calculateGreeks(const GreeksParams& params);
+
+	[[nodiscard]] PricingCacheStats getStats() const;
+	void clear();
+
+private:
+	// Quantized inputs (S, K, T, σ, r, q) plus what is being computed, the hash is computed once when the key is built
+	struct Key
+	{
+		std::array<std::int64_t, 6> values{};
+		OptionType option_type{};
+		bool greeks{};
+		std::uint64_t hash{};
+
+		[[nodiscard]] inline bool operator==(const Key& other) const noexcept
+		{
+			return values == other.values && option_type == other.option_type && greeks == other.greeks;
+		}
+	};
+
+	struct KeyHash
+	{
+		[[nodiscard]] std::size_t operator()(const Key& key) const noexcept;
+	};
+
+	using Entry = std::pair<Key, OptionGreeks>;
+
+	// One independently locked LRU, the most recently used entry is at the front of the list
+	struct alignas(64) Shard
+	{
+		std::mutex mutex{};
+		std::list<Entry> entries{};
+		std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index{};
+		std::uint64_t hits{};
+		std::uint64_t misses{};
+		std::uint64_t evictions{};
+	};
+
+	PricingCacheConfig config_{};
+	double inverse_price_step_{};
+	double inverse_time_step_{};
+	double inverse_volatility_step_{};
+	double inverse_rate_step_{};
+	std::size_t shard_capacity_{};
+	std::unique_ptr<Shard[]> shards_{};
+	FinancialCalculator calculator_{};
+
+	[[nodiscard]] static std::int64_t quantize(double value, double inverse_step) noexcept;
+	[[nodiscard]] Key makeKey(const GreeksParams& params, bool greeks) const noexcept;
+	[[nodiscard]] Shard& shardOf(const Key& key) const noexcept;
+
+	template<typename Compute>
+	[[nodiscard]] OptionGreeks lookup(const Key& key, Compute&& compute);
+};
@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+/*
+*	Cancellation and deadline of the asynchronous pricing requests of FinancialCalculator (the *Async pricers)
+*
+*	-.A request is split into tasks (path chunks, chain slices), every task checks its control before starting: once the request is
+*	cancelled or past its deadline the remaining tasks are skipped and the callback gets a PricingCancelled error
+*	-.A task already running finishes its chunk, so a request stops within one task (MONTE_CARLO_TASK_SAMPLES paths, CHAIN_TASK_SIZE contracts)
+*	-.Copies of a PricingControl share the same cancellation flag: keep one to cancel the request it was given to
+*/
+
+// Error delivered to the callback of a request that was cancelled or ran past its deadline
+class PricingCancelled : public std::runtime_error
+{
+public:
+	explicit PricingCancelled(const char* message) : std::runtime_error(message) {}
+};
+
+class PricingControl
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	PricingControl() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+	explicit PricingControl(const Clock::time_point deadline) : cancelled_(std::make_shared<std::atomic<bool>>(false)), deadline_(deadline) {}
+
+	// @withTimeout : Control whose deadline is timeout from now
+	template<typename Rep, typename Period>
+	[[nodiscard]] static PricingControl withTimeout(const std::chrono::duration<Rep, Period> timeout) { return PricingControl(Clock::now() + timeout); }
+
+	// @cancel : Any thread, the tasks of the request not started yet are skipped
+	void cancel() const noexcept { cancelled_->store(true, std::memory_order_relaxed); }
+
+	[[nodiscard]] inline bool cancelled() const noexcept { return cancelled_->load(std::memory_order_relaxed); }
+	[[nodiscard]] inline bool expired() const noexcept { return deadline_ != Clock::time_point::max() && Clock::now() >= deadline_; }
+	[[nodiscard]] inline Clock::time_point deadline() const noexcept { return deadline_; }
+
+	// @check : Throws PricingCancelled once the request is cancelled or past its deadline
+	void check() const
+	{
+		if (cancelled()) throw PricingCancelled("[!] Pricing request cancelled");
+		if (expired()) throw PricingCancelled("[!] Pricing request deadline exceeded");
+	}
+
+private:
+	std::shared_ptr<std::atomic<bool>> cancelled_;
+	Clock::time_point deadline_{ Clock::time_point::max() };
+};
+
+// Completion of an asynchronous request, run on a worker thread: the result, or a default result with the error of the request
+template<typename Result>
+using PricingCallback = std::function<void(Result result, std::exception_ptr error)>;
+
+// Completion of an asynchronous chain request, the outputs are written in place (their content is unspecified after an error)
+using ChainPricingCallback = std::function<void(std::exception_ptr error)>;
@@ -0,0 +1,216 @@
+﻿#include "quasi_random.h"
+#include "random.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace
+{
+	// @multiplyModulo : a * b mod p over GF(2), the polynomials are bit masks (bit i is the coefficient of x^i)
+	[[nodiscard]] std::uint64_t multiplyModulo(std::uint64_t a, std::uint64_t b, const std::uint64_t p, const int degree) noexcept
+	{
+		std::uint64_t product{ 0 };
+		while (b != 0)
+		{
+			if (b & 1) product ^= a;
+			b >>= 1;
+			a <<= 1;
+			if (a & (1ULL << degree)) a ^= p;
+		}
+		return product;
+	}
+
+	[[nodiscard]] std::uint64_t powerModulo(std::uint64_t exponent, const std::uint64_t p, const int degree) noexcept
+	{
+		std::uint64_t result{ 1 };
+		std::uint64_t base{ 2 };	// x
+		while (exponent != 0)
+		{
+			if (exponent & 1) result = multiplyModulo(result, base, p, degree);
+			base = multiplyModulo(base, base, p, degree);
+			exponent >>= 1;
+		}
+		return result;
+	}
+
+	// @isPrimitive : p (degree d) is primitive when x has order exactly 2^d - 1 modulo p
+	[[nodiscard]] bool isPrimitive(const std::uint64_t p, const int degree) noexcept
+	{
+		const std::uint64_t order = (1ULL << degree) - 1;
+		if (powerModulo(order, p, degree) != 1) return false;
+
+		std::uint64_t remaining = order;
+		for (std::uint64_t factor{ 2 }; factor * factor <= remaining; ++factor)
+		{
+			if (remaining % factor != 0) continue;
+			if (powerModulo(order / factor, p, degree) == 1) return false;
+			while (remaining % factor == 0) remaining /= factor;
+		}
+		return remaining == 1 || powerModulo(order / remaining, p, degree) != 1;
+	}
+}
+
+SobolSequence::SobolSequence(const std::size_t dimensions, std::pmr::memory_resource* resource)
+	: dimensions_(dimensions), directions_(dimensions * BITS, resource), state_(dimensions, resource), shift_(dimensions, resource)
+{
+	if (dimensions == 0 || dimensions > MAX_DIMENSIONS)
+	{
+		throw std::invalid_argument("[!] Sobol dimensions must be between 1 and " + std::to_string(MAX_DIMENSIONS));
+	}
+
+	// Van der Corput
+	for (std::size_t bit{ 0 }; bit < BITS; ++bit)
+	{
+		directions_[bit] = 1U << (BITS - 1 - bit);
+	}
+
+	std::uint64_t initial_numbers_state{ 0x5eed5eed5eed5eedULL };
+	std::uint64_t polynomial{ 3 };	// x + 1
+	int degree{ 1 };
+
+	for (std::size_t dimension{ 1 }; dimension < dimensions; ++dimension)
+	{
+		while (!isPrimitive(polynomial, degree))
+		{
+			polynomial += 2;	// Primitive polynomials have a constant term, only odd masks are candidates
+			if (polynomial >> (degree + 1)) degree += 1;
+		}
+
+		std::uint32_t* direction = directions_.data() + dimension * BITS;
+		for (int k{ 1 }; k <= degree && k <= static_cast<int>(BITS); ++k)
+		{
+			// Odd initial direction number m_k < 2^k
+			initial_numbers_state = splitMix64(initial_numbers_state);
+			const std::uint32_t m = static_cast<std::uint32_t>(initial_numbers_state & ((1ULL << k) - 1)) | 1U;
+			direction[k - 1] = m << (BITS - k);
+		}
+
+		// v_k = v_(k-d) ^ (v_(k-d) >> d) ^ sum of a_i * v_(k-i), with p = x^d + a_1 x^(d-1) + ... + a_(d-1) x + 1
+		for (int k{ degree + 1 }; k <= static_cast<int>(BITS); ++k)
+		{
+			std::uint32_t value = direction[k - degree - 1] ^ (direction[k - degree - 1] >> degree);
+			for (int i{ 1 }; i < degree; ++i)
+			{
+				if ((polynomial >> (degree - i)) & 1) value ^= direction[k - i - 1];
+			}
+			direction[k - 1] = value;
+		}
+
+		polynomial += 2;
+		if (polynomial >> (degree + 1)) degree += 1;
+	}
+
+	seek(0);
+}
+
+SobolSequence::SobolSequence(const SobolSequence& other, std::pmr::memory_resource* resource)
+	: dimensions_(other.dimensions_), directions_(other.directions_, resource), state_(other.state_, resource), shift_(other.shift_, resource), index_(other.index_)
+{
+}
+
+void SobolSequence::setDigitalShift(const std::uint64_t seed) noexcept
+{
+	std::uint64_t shift_state = seed;
+	for (auto& shift : shift_)
+	{
+		shift_state = splitMix64(shift_state);
+		shift = seed != 0 ? static_cast<std::uint32_t>(shift_state >> 32) : 0U;
+	}
+}
+
+void SobolSequence::seek(const std::uint64_t index) noexcept
+{
+	index_ = index;
+
+	const std::uint64_t gray_code = index ^ (index >> 1);
+	for (std::size_t dimension{ 0 }; dimension < dimensions_; ++dimension)
+	{
+		std::uint32_t value{ 0 };
+		for (std::size_t bit{ 0 }; bit < BITS; ++bit)
+		{
+			if ((gray_code >> bit) & 1) value ^= directions_[dimension * BITS + bit];
+		}
+		state_[dimension] = value;
+	}
+}
+
+void SobolSequence::next(double* point) noexcept
+{
+	constexpr double SCALE = 1.0 / 4294967296.0;	// 2^-32
+	for (std::size_t dimension{ 0 }; dimension < dimensions_; ++dimension)
+	{
+		point[dimension] = (static_cast<double>(state_[dimension] ^ shift_[dimension]) + 0.5) * SCALE;
+	}
+
+	// Gray code order: the point after index i differs from it by the direction of the lowest set bit of i + 1
+	++index_;
+	std::size_t bit{ 0 };
+	while (((index_ >> bit) & 1) == 0 && bit + 1 < BITS) ++bit;
+
+	for (std::size_t dimension{ 0 }; dimension < dimensions_; ++dimension)
+	{
+		state_[dimension] ^= directions_[dimension * BITS + bit];
+	}
+}
+
+/*
+	@BrownianBridge: Construction order over the points 1..steps (time in units of one step, W(0) = 0)
+	-.The first normal sets W(steps) = sqrt(steps) * Z
+	-.Then, breadth first, every interval (l, r) with an unknown point inside gets its midpoint m:
+		W(m) = ((r - m) * W(l) + (m - l) * W(r)) / (r - l) + sqrt((m - l) * (r - m) / (r - l)) * Z
+*/
+BrownianBridge::BrownianBridge(const std::size_t steps, std::pmr::memory_resource* resource)
+	: steps_(steps), target_(steps, resource), left_(steps, resource), right_(steps, resource), left_weight_(steps, resource), right_weight_(steps, resource),
+	standard_deviation_(steps, resource)
+{
+	if (steps == 0)
+	{
+		throw std::invalid_argument("[!] The Brownian bridge needs at least one step");
+	}
+
+	target_[0] = steps;
+	standard_deviation_[0] = std::sqrt(static_cast<double>(steps));
+
+	std::pmr::vector<std::pair<std::size_t, std::size_t>> intervals(resource);
+	intervals.reserve(2 * steps);	// Every point but the last one splits an interval in two
+	intervals.emplace_back(0, steps);
+	std::size_t k{ 1 };
+	for (std::size_t current{ 0 }; current < intervals.size(); ++current)
+	{
+		const auto [left, right] = intervals[current];
+		if (right - left < 2) continue;
+
+		const std::size_t middle = left + (right - left) / 2;
+		const double span = static_cast<double>(right - left);
+
+		target_[k] = middle;
+		left_[k] = left;
+		right_[k] = right;
+		left_weight_[k] = static_cast<double>(right - middle) / span;
+		right_weight_[k] = static_cast<double>(middle - left) / span;
+		standard_deviation_[k] = std::sqrt(static_cast<double>(middle - left) * static_cast<double>(right - middle) / span);
+		++k;
+
+		intervals.emplace_back(left, middle);
+		intervals.emplace_back(middle, right);
+	}
+}
+
+void BrownianBridge::buildIncrements(const double* normals, double* increments) const noexcept
+{
+	// W(i) is stored in increments[i - 1] first, then the increments are taken in place from the end
+	const auto path = [increments](const std::size_t point) { return point == 0 ? 0.0 : increments[point - 1]; };
+
+	increments[steps_ - 1] = standard_deviation_[0] * normals[0];
+	for (std::size_t k{ 1 }; k < steps_; ++k)
+	{
+		increments[target_[k] - 1] = left_weight_[k] * path(left_[k]) + right_weight_[k] * path(right_[k]) + standard_deviation_[k] * normals[k];
+	}
+
+	for (std::size_t i{ steps_ - 1 }; i > 0; --i)
+	{
+		increments[i] -= increments[i - 1];
+	}
+}
@@ -0,0 +1,68 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+/*
+*	Quasi-Monte Carlo building blocks
+*
+*	-.SobolSequence : Low-discrepancy points of the unit hypercube, generated in Gray code order (one XOR per dimension and point)
+*		-. Dimension 0 is the van der Corput sequence, dimension j > 0 uses the j-th primitive polynomial over GF(2) (in increasing
+*		degree) with odd initial direction numbers drawn from a fixed splitmix64 stream. They are valid Sobol nets but not the tuned
+*		Joe-Kuo numbers, which the Brownian bridge compensates by putting most of the variance in the first coordinates.
+*		-. A digital shift (XOR of a random word per dimension) randomizes the sequence while keeping its net properties,
+*		independent shifts give independent replicates of the whole point set (randomized QMC)
+*		-. Coordinates are ((x ^ shift) + 0.5) / 2^32, so they never reach 0 or 1
+*	-.BrownianBridge : Maps standard normals, ordered by importance, onto the increments of a Brownian path over equal steps.
+*	The first normal fixes the terminal value, the next ones the midpoints of ever finer intervals.
+*	-.Both take the memory resource their tables are allocated from (the default resource unless the caller passes a scratch arena)
+*/
+
+class SobolSequence
+{
+public:
+	static constexpr std::size_t MAX_DIMENSIONS = 4096;
+	static constexpr std::size_t BITS = 32;
+
+	explicit SobolSequence(std::size_t dimensions, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	SobolSequence(const SobolSequence& other, std::pmr::memory_resource* resource);
+
+	[[nodiscard]] inline std::size_t dimensions() const noexcept { return dimensions_; }
+
+	// @setDigitalShift : XOR every coordinate with a word drawn from seed (0 removes the shift)
+	void setDigitalShift(std::uint64_t seed) noexcept;
+
+	// @seek : The next call to next() returns the point of the given index
+	void seek(std::uint64_t index) noexcept;
+
+	// @next : Writes the current point (dimensions coordinates in (0, 1)) into point and moves to the following one
+	void next(double* point) noexcept;
+
+private:
+	std::size_t dimensions_{};
+	std::pmr::vector<std::uint32_t> directions_{};	// directions_[dimension * BITS + bit]
+	std::pmr::vector<std::uint32_t> state_{};
+	std::pmr::vector<std::uint32_t> shift_{};
+	std::uint64_t index_{};
+};
+
+class BrownianBridge
+{
+public:
+	explicit BrownianBridge(std::size_t steps, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	[[nodiscard]] inline std::size_t steps() const noexcept { return steps_; }
+
+	// @buildIncrements : Standard normals (importance order) -> the steps unit variance increments W(i) - W(i - 1) of the same path
+	void buildIncrements(const double* normals, double* increments) const noexcept;
+
+private:
+	std::size_t steps_{};
+	std::pmr::vector<std::size_t> target_{};	// Point fixed by the k-th normal
+	std::pmr::vector<std::size_t> left_{};	// Known neighbours it is interpolated between (0 is the start, W(0) = 0)
+	std::pmr::vector<std::size_t> right_{};
+	std::pmr::vector<double> left_weight_{};
+	std::pmr::vector<double> right_weight_{};
+	std::pmr::vector<double> standard_deviation_{};
+};
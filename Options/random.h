@@ -0,0 +1,263 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <type_traits>
+
+/*
+*	Random number engines usable by RandomGenerator
+*
+*	-.Every engine is a UniformRandomBitGenerator producing 64 random bits per call, built from an explicit (seed, stream) pair:
+*	the same pair always replays the same sequence and different streams of the same seed never overlap in practice.
+*		-. MersenneTwisterEngine : std::mt19937_64 seeded through std::seed_seq (the historical engine of the calculator)
+*		-. Xoshiro256PlusPlus    : Blackman & Vigna's xoshiro256++, 4 words of state and a couple of cycles per draw. The stream is
+*		hashed into the seed before its splitmix64 expansion, so any stream is created in O(1) (starting points spread at random
+*		over a 2^256 - 1 period), jump() still leaps 2^128 draws ahead for callers splitting one sequence
+*		-. Philox4x32            : Salmon et al. counter-based Philox4x32-10, the output is a pure function of (key, counter) so
+*		stream k is simply the counter block k * 2^64, any stream or position is reached in O(1)
+*/
+
+// @splitMix64 : Bijective 64 bit mixer used to expand seeds into engine states
+[[nodiscard]] constexpr std::uint64_t splitMix64(std::uint64_t value) noexcept
+{
+	value += 0x9e3779b97f4a7c15ULL;
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+	return value ^ (value >> 31);
+}
+
+// @freshSeed : Non reproducible seed, std::random_device is only read once per process and later seeds advance a splitmix64 sequence
+[[nodiscard]] inline std::uint64_t freshSeed() noexcept
+{
+	static std::atomic<std::uint64_t> state{ (static_cast<std::uint64_t>(std::random_device{}()) << 32) | std::random_device{}() };
+	return splitMix64(state.fetch_add(0x9e3779b97f4a7c15ULL, std::memory_order_relaxed));
+}
+
+class MersenneTwisterEngine
+{
+private:
+	std::mt19937_64 engine_{};
+
+public:
+	using result_type = std::uint64_t;
+
+	MersenneTwisterEngine(const std::uint64_t seed, const std::uint64_t stream)
+	{
+		std::seed_seq sequence{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+			static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32) };
+		engine_.seed(sequence);
+	}
+
+	[[nodiscard]] static constexpr result_type min() noexcept { return 0; }
+	[[nodiscard]] static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+	[[nodiscard]] inline result_type operator()() noexcept { return engine_(); }
+};
+
+class Xoshiro256PlusPlus
+{
+private:
+	std::array<std::uint64_t, 4> state_{};
+
+	[[nodiscard]] static constexpr std::uint64_t rotateLeft(const std::uint64_t value, const int bits) noexcept { return (value << bits) | (value >> (64 - bits)); }
+
+public:
+	using result_type = std::uint64_t;
+
+	Xoshiro256PlusPlus(const std::uint64_t seed, const std::uint64_t stream) noexcept
+	{
+		std::uint64_t expanded = seed ^ splitMix64(stream);
+		for (auto& word : state_)
+		{
+			word = splitMix64(expanded);
+			expanded += 0x9e3779b97f4a7c15ULL;
+		}
+	}
+
+	// @jump : Advances the state by 2^128 draws
+	inline void jump() noexcept
+	{
+		constexpr std::uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+		std::array<std::uint64_t, 4> jumped{};
+		for (const auto word : JUMP)
+		{
+			for (int bit{ 0 }; bit < 64; ++bit)
+			{
+				if (word & (1ULL << bit))
+				{
+					for (std::size_t i{ 0 }; i < 4; ++i) jumped[i] ^= state_[i];
+				}
+				static_cast<void>((*this)());
+			}
+		}
+		state_ = jumped;
+	}
+
+	[[nodiscard]] static constexpr result_type min() noexcept { return 0; }
+	[[nodiscard]] static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+	[[nodiscard]] inline result_type operator()() noexcept
+	{
+		const std::uint64_t result = rotateLeft(state_[0] + state_[3], 23) + state_[0];
+		const std::uint64_t shifted = state_[1] << 17;
+
+		state_[2] ^= state_[0];
+		state_[3] ^= state_[1];
+		state_[1] ^= state_[2];
+		state_[0] ^= state_[3];
+		state_[2] ^= shifted;
+		state_[3] = rotateLeft(state_[3], 45);
+
+		return result;
+	}
+};
+
+class Philox4x32
+{
+private:
+	std::array<std::uint32_t, 4> counter_{};	// (block low, block high, stream low, stream high)
+	std::array<std::uint32_t, 2> key_{};
+	std::array<std::uint32_t, 4> block_{};
+	std::size_t position_{ 4 };			// Next unread 32 bit word of block_ (4 ⇒ a new block must be generated)
+
+	// @generateBlock : Ten Philox rounds over the current counter, then the counter is incremented
+	inline void generateBlock() noexcept
+	{
+		constexpr std::uint64_t MULTIPLIER_0 = 0xD2511F53;
+		constexpr std::uint64_t MULTIPLIER_1 = 0xCD9E8D57;
+		constexpr std::uint32_t WEYL_0 = 0x9E3779B9;
+		constexpr std::uint32_t WEYL_1 = 0xBB67AE85;
+
+		std::array<std::uint32_t, 4> x = counter_;
+		std::array<std::uint32_t, 2> key = key_;
+		for (int round{ 0 }; round < 10; ++round)
+		{
+			const std::uint64_t product_0 = MULTIPLIER_0 * x[0];
+			const std::uint64_t product_1 = MULTIPLIER_1 * x[2];
+			x = { static_cast<std::uint32_t>(product_1 >> 32) ^ x[1] ^ key[0], static_cast<std::uint32_t>(product_1),
+				static_cast<std::uint32_t>(product_0 >> 32) ^ x[3] ^ key[1], static_cast<std::uint32_t>(product_0) };
+			key[0] += WEYL_0;
+			key[1] += WEYL_1;
+		}
+
+		block_ = x;
+		position_ = 0;
+		if (++counter_[0] == 0) ++counter_[1];
+	}
+
+public:
+	using result_type = std::uint64_t;
+
+	Philox4x32(const std::uint64_t seed, const std::uint64_t stream) noexcept
+		: counter_{ 0, 0, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32) },
+		key_{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) } {}
+
+	[[nodiscard]] static constexpr result_type min() noexcept { return 0; }
+	[[nodiscard]] static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+	// @seek : Jumps to the given 128 bit block of the stream (each block holds two 64 bit draws)
+	inline void seek(const std::uint64_t block) noexcept
+	{
+		counter_[0] = static_cast<std::uint32_t>(block);
+		counter_[1] = static_cast<std::uint32_t>(block >> 32);
+		position_ = 4;
+	}
+
+	[[nodiscard]] inline result_type operator()() noexcept
+	{
+		if (position_ == 4) generateBlock();
+
+		const std::uint64_t low = block_[position_++];
+		const std::uint64_t high = block_[position_++];
+		return (high << 32) | low;
+	}
+};
+
+// Random engines selectable at runtime by the calculators
+enum class RandomEngine
+{
+	MersenneTwister,
+	Xoshiro256,
+	Philox,
+};
+
+// Small class used to generate values under certain type (only numeric values allowed) and bound constraints
+template<typename RandomType, typename Engine = MersenneTwisterEngine>
+class RandomGenerator
+{
+private:
+	static_assert(std::is_arithmetic_v<RandomType>, "[!] The type must be a numeric type");
+	static_assert(std::is_same_v<typename Engine::result_type, std::uint64_t>, "[!] The engine must produce 64 random bits per draw");
+
+	Engine gen;
+	RandomType left_limit_{};
+	RandomType right_limit_{};
+	std::uniform_int_distribution<std::conditional_t<std::is_integral_v<RandomType>, RandomType, int>> integer_distribution;
+
+	// @toUnitInterval : Maps 64 random bits to the 53 bit grid of [0, 1)
+	[[nodiscard]] static constexpr double toUnitInterval(const std::uint64_t bits) noexcept { return static_cast<double>(bits >> 11) * 0x1.0p-53; }
+
+public:
+	RandomGenerator(const RandomType left_limit, const RandomType right_limit) noexcept
+		: RandomGenerator(left_limit, right_limit, freshSeed(), 0) {}
+
+	// Reproducible generator: the same (seed, stream) pair always yields the same sequence, different streams yield independent sequences
+	RandomGenerator(const RandomType left_limit, const RandomType right_limit, const std::uint64_t seed, const std::uint64_t stream)
+		: gen(seed, stream), left_limit_(std::min(left_limit, right_limit)), right_limit_(std::max(left_limit, right_limit))
+	{
+		if constexpr (std::is_integral_v<RandomType>)
+		{
+			integer_distribution = decltype(integer_distribution)(left_limit_, right_limit_);
+		}
+	}
+
+	// @getRandomValue : Uniform value in [left, right) for floating point types, [left, right] for integers
+	[[nodiscard]] inline RandomType getRandomValue() noexcept
+	{
+		if constexpr (std::is_floating_point_v<RandomType>)
+		{
+			return left_limit_ + (right_limit_ - left_limit_) * static_cast<RandomType>(toUnitInterval(gen()));
+		}
+		else
+		{
+			return integer_distribution(gen);
+		}
+	}
+
+	// @fillUniform : Writes size uniform values (same distribution as getRandomValue) into out
+	inline void fillUniform(RandomType* out, const std::size_t size) noexcept
+	{
+		for (std::size_t i{ 0 }; i < size; ++i)
+		{
+			out[i] = getRandomValue();
+		}
+	}
+
+	// @fillNormal : Writes size standard normal values into out (independent of the uniform bounds), both Box-Muller outputs are kept
+	inline void fillNormal(RandomType* out, const std::size_t size) noexcept
+	{
+		static_assert(std::is_floating_point_v<RandomType>, "[!] Normal values need a floating point type");
+
+		constexpr double TWO_PI = 6.28318530717958647692;
+		for (std::size_t i{ 0 }; i < size; i += 2)
+		{
+			const double u1 = 1.0 - toUnitInterval(gen());	// (0, 1] so the logarithm stays finite
+			const double u2 = toUnitInterval(gen());
+			const double radius = std::sqrt(-2.0 * std::log(u1));
+
+			out[i] = static_cast<RandomType>(radius * std::cos(TWO_PI * u2));
+			if (i + 1 < size)
+			{
+				out[i + 1] = static_cast<RandomType>(radius * std::sin(TWO_PI * u2));
+			}
+		}
+	}
+
+	[[nodiscard]] inline Engine& engine() noexcept { return gen; }
+};
@@ -0,0 +1,172 @@
+﻿#include "scenario_grid.h"
+#include "simd.h"
+#include "metrics.h"
+
+#include <thread>
+
+ScenarioGrid::ScenarioGrid(ScenarioShocks shocks) : shocks_(std::move(shocks))
+{
+	if (shocks_.spot.empty() || shocks_.volatility.empty() || shocks_.interest_rate.empty())
+	{
+		throw std::invalid_argument("[!] Every shock vector needs at least one shock (0 for the base)");
+	}
+
+	log_spot_factor_.reserve(shocks_.spot.size());
+	spot_factor_.reserve(shocks_.spot.size());
+	for (const double shock : shocks_.spot)
+	{
+		if (!(shock > -1.0)) throw std::invalid_argument("[!] Spot shocks must be above -1 (relative shocks)");
+		spot_factor_.push_back(1.0 + shock);
+		log_spot_factor_.push_back(std::log1p(shock));
+	}
+}
+
+namespace
+{
+	// Columns of the per contract invariants, sized for the shocks of one grid
+	struct ContractTerms
+	{
+		double* volatility_sqrt_time;		// σ'√T per volatility shock
+		double* inverse_volatility_sqrt_time;
+		double* half_variance_time;		// σ'²T / 2
+		double* rate_time;			// r'T per rate shock
+		double* strike_discount;		// K e^(-r'T)
+		double* arguments;			// ±d1 of every scenario, then ±d2 (their N(·) once the kernel ran)
+	};
+
+	[[nodiscard]] std::size_t contractScratchSize(const ScenarioShocks& shocks, const std::size_t scenarios) noexcept
+	{
+		return 3 * shocks.volatility.size() + 2 * shocks.interest_rate.size() + 2 * scenarios;
+	}
+
+	[[nodiscard]] ContractTerms contractTerms(const ScenarioShocks& shocks, double* scratch) noexcept
+	{
+		const std::size_t volatilities = shocks.volatility.size();
+		const std::size_t rates = shocks.interest_rate.size();
+
+		ContractTerms terms;
+		terms.volatility_sqrt_time = scratch;
+		terms.inverse_volatility_sqrt_time = scratch + volatilities;
+		terms.half_variance_time = scratch + 2 * volatilities;
+		terms.rate_time = scratch + 3 * volatilities;
+		terms.strike_discount = scratch + 3 * volatilities + rates;
+		terms.arguments = scratch + 3 * volatilities + 2 * rates;
+		return terms;
+	}
+}
+
+void ScenarioGrid::price(const OptionChain& chain, Price* cube, std::size_t number_of_threads) const
+{
+	FC_METRICS_SCOPE(ScenarioGrid);
+	FC_METRICS_ITEMS(chain.size * scenarios());
+
+	const double lowest_volatility_shock = *std::min_element(shocks_.volatility.begin(), shocks_.volatility.end());
+	for (std::size_t i{ 0 }; i < chain.size; ++i)
+	{
+		if (chain.time[i] <= 0) throw std::runtime_error("[!] Time must be positive");
+		if (chain.volatility[i] <= 0) throw std::runtime_error("[!] Volatility must be positive");
+		if (!(chain.volatility[i] + lowest_volatility_shock > 0)) throw std::invalid_argument("[!] Shocked volatilities must stay positive");
+		if (chain.option_type[i] != OptionType::Call && chain.option_type[i] != OptionType::Put)
+		{
+			throw std::invalid_argument("[!] Invalid option type: must be Call or Put.");
+		}
+	}
+	if (chain.size == 0) return;
+
+	const std::size_t scenario_count = scenarios();
+	const std::size_t spots = shocks_.spot.size();
+	const std::size_t volatilities = shocks_.volatility.size();
+	const std::size_t rates = shocks_.interest_rate.size();
+
+	number_of_threads = number_of_threads != 0 ? number_of_threads : std::max(1u, std::thread::hardware_concurrency());
+	number_of_threads = std::min(number_of_threads, chain.size);
+
+	// Every allocation happens here on the calling thread, one slice of scratch per worker
+	std::pmr::memory_resource* resource = &threadScratchArena();
+	const std::size_t worker_scratch = contractScratchSize(shocks_, scenario_count);
+	std::pmr::vector<double> scratch(number_of_threads * worker_scratch, resource);
+
+	const auto price_contracts = [&](const std::size_t first, const std::size_t last, double* worker_scratch_begin)
+	{
+		const ContractTerms terms = contractTerms(shocks_, worker_scratch_begin);
+		double* const d1_arguments = terms.arguments;
+		double* const d2_arguments = terms.arguments + scenario_count;
+
+		for (std::size_t i{ first }; i < last; ++i)
+		{
+			const double sign = chain.option_type[i] == OptionType::Call ? 1.0 : -1.0;
+			const double time = chain.time[i];
+			const double sqrt_time = std::sqrt(time);
+			const double log_moneyness = std::log(chain.underlying_price[i] / chain.strike_price[i]);
+			const double dividend_yield = chain.dividend_yield != nullptr ? chain.dividend_yield[i] : 0.0;
+			const double spot_term = chain.underlying_price[i] * std::exp(-dividend_yield * time);
+
+			for (std::size_t v{ 0 }; v < volatilities; ++v)
+			{
+				const double volatility = chain.volatility[i] + shocks_.volatility[v];
+				terms.volatility_sqrt_time[v] = volatility * sqrt_time;
+				terms.inverse_volatility_sqrt_time[v] = 1.0 / terms.volatility_sqrt_time[v];
+				terms.half_variance_time[v] = 0.5 * volatility * volatility * time;
+			}
+			for (std::size_t r{ 0 }; r < rates; ++r)
+			{
+				terms.rate_time[r] = (chain.interest_rate[i] + shocks_.interest_rate[r]) * time;
+				terms.strike_discount[r] = chain.strike_price[i] * std::exp(-terms.rate_time[r]);
+			}
+
+			// d1 = (ln(S / K) + ln(1 + shock) + r'T + σ'²T / 2) / (σ'√T), the arguments of N(·) are staged then evaluated in place
+			std::size_t scenario{ 0 };
+			for (std::size_t s{ 0 }; s < spots; ++s)
+			{
+				const double log_spot_moneyness = log_moneyness + log_spot_factor_[s];
+				for (std::size_t v{ 0 }; v < volatilities; ++v)
+				{
+					const double drift = log_spot_moneyness + terms.half_variance_time[v];
+					for (std::size_t r{ 0 }; r < rates; ++r, ++scenario)
+					{
+						const double d1 = (drift + terms.rate_time[r]) * terms.inverse_volatility_sqrt_time[v];
+						d1_arguments[scenario] = sign * d1;
+						d2_arguments[scenario] = sign * (d1 - terms.volatility_sqrt_time[v]);
+					}
+				}
+			}
+			normalCdfBatch(terms.arguments, terms.arguments, 2 * scenario_count);
+
+			// price = sign * (S' e^(-qT) N(sign * d1) - K e^(-r'T) N(sign * d2))
+			Price* const prices = cube + i * scenario_count;
+			scenario = 0;
+			for (std::size_t s{ 0 }; s < spots; ++s)
+			{
+				const double shocked_spot_term = spot_term * spot_factor_[s];
+				for (std::size_t v{ 0 }; v < volatilities; ++v)
+				{
+					for (std::size_t r{ 0 }; r < rates; ++r, ++scenario)
+					{
+						prices[scenario] = sign * (shocked_spot_term * d1_arguments[scenario] - terms.strike_discount[r] * d2_arguments[scenario]);
+					}
+				}
+			}
+		}
+	};
+
+	const auto run_worker = [&](const std::size_t worker)
+	{
+		const std::size_t base = chain.size / number_of_threads;
+		const std::size_t remainder = chain.size % number_of_threads;
+		const std::size_t first = worker * base + std::min(worker, remainder);
+		price_contracts(first, first + base + (worker < remainder ? 1 : 0), scratch.data() + worker * worker_scratch);
+	};
+
+	std::pmr::vector<std::thread> workers(resource);
+	workers.reserve(number_of_threads - 1);
+	for (std::size_t worker{ 1 }; worker < number_of_threads; ++worker)
+	{
+		workers.emplace_back(run_worker, worker);
+	}
+	run_worker(0); // The calling thread takes the first slice instead of idling
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include "options.h"
+
+#include <vector>
+
+/*
+*	Scenario engine of the risk reports: every contract of a chain repriced over the cartesian product of spot, volatility and rate
+*	shocks (bump and reprice with the Black-Scholes model), written into a dense cube
+*
+*	-.Spot shocks are relative (S * (1 + shock)), volatility and rate shocks absolute (σ + shock, r + shock), a 0 shock is the base
+*	-.The shared invariants are computed once: ln(1 + shock) per spot shock, sqrt(T) and ln(S / K) per contract, σ'√T and σ'²T / 2
+*	per volatility shock and e^(-r'T) per rate shock of a contract, so a scenario costs a few multiply-adds and the two N(·)
+*	-.The N(·) of a contract's scenarios run through the vectorized kernels of simd.h, contracts are split across worker threads
+*	-.The dividend_yield column is honoured like in calculateGreeks (nullptr means no dividends, the base scenario then matches calculateBlackScholes)
+*/
+
+// Shock vectors of a grid, e.g. 21 spot x 11 volatility x 5 rate shocks
+struct ScenarioShocks
+{
+	std::vector<double> spot{ 0.0 };		// Relative, every shock must be above -1
+	std::vector<Volatility> volatility{ 0.0 };	// Absolute, every shocked volatility must stay positive
+	std::vector<InterestRate> interest_rate{ 0.0 };	// Absolute
+};
+
+class ScenarioGrid
+{
+private:
+	ScenarioShocks shocks_;
+	std::vector<double> log_spot_factor_{};	// ln(1 + spot shock)
+	std::vector<double> spot_factor_{};	// 1 + spot shock
+
+public:
+	explicit ScenarioGrid(ScenarioShocks shocks);
+
+	[[nodiscard]] inline const ScenarioShocks& getShocks() const noexcept { return shocks_; }
+	[[nodiscard]] inline std::size_t scenarios() const noexcept { return shocks_.spot.size() * shocks_.volatility.size() * shocks_.interest_rate.size(); }
+
+	// @index : Position of a (contract, spot, volatility, rate) scenario in the cube, contract-major then spot, volatility and rate
+	[[nodiscard]] inline std::size_t index(const std::size_t contract, const std::size_t spot, const std::size_t volatility, const std::size_t rate) const noexcept
+	{
+		return ((contract * shocks_.spot.size() + spot) * shocks_.volatility.size() + volatility) * shocks_.interest_rate.size() + rate;
+	}
+
+	/*
+		@price: cube[index(i, s, v, r)] = price of contract i under spot shock s, volatility shock v and rate shock r
+		-.cube must point to at least chain.size * scenarios() elements
+		-.The chain is validated first (positive time and volatility, shocked volatilities included, Call / Put types)
+		-.number_of_threads workers (0 uses every hardware thread) take contiguous slices of contracts, the calling thread the first one,
+		their scratch is taken from the calling thread's arena up front
+	*/
+	void price(const OptionChain& chain, Price* cube, std::size_t number_of_threads = 1) const;
+};
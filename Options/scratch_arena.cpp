@@ -0,0 +1,107 @@
+﻿#include "scratch_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+ScratchArena::ScratchArena(const std::size_t initial_capacity, std::pmr::memory_resource* upstream)
+	: upstream_(upstream), next_block_size_(std::max<std::size_t>(initial_capacity, 64))
+{
+	// The first block is only taken on the first allocation, an arena of a thread that never prices costs nothing
+}
+
+ScratchArena::~ScratchArena()
+{
+	release();
+}
+
+void ScratchArena::release() noexcept
+{
+	while (current_ != nullptr)
+	{
+		Block* previous = current_->previous;
+		upstream_->deallocate(current_, sizeof(Block) + current_->size, alignof(std::max_align_t));
+		current_ = previous;
+	}
+
+	cursor_ = nullptr;
+	end_ = nullptr;
+	capacity_ = 0;
+	live_allocations_ = 0;
+}
+
+void ScratchArena::pushBlock(std::size_t size)
+{
+	size = std::max(size, next_block_size_);
+
+	Block* block = static_cast<Block*>(upstream_->allocate(sizeof(Block) + size, alignof(std::max_align_t)));
+	block->previous = current_;
+	block->size = size;
+
+	current_ = block;
+	cursor_ = reinterpret_cast<char*>(block + 1);
+	end_ = cursor_ + size;
+	capacity_ += size;
+	next_block_size_ = 2 * size;
+	++upstream_allocations_;
+}
+
+/*
+	@rewind: Nothing is alive anymore, the next allocation starts back at the beginning
+	-.Several blocks are replaced by a single one of their total size, so the next call of the same size fits in it
+	-.If that block can't be allocated the arena is left empty and the next allocation takes a fresh one
+*/
+void ScratchArena::rewind() noexcept
+{
+	if (current_ != nullptr && current_->previous != nullptr)
+	{
+		const std::size_t total = capacity_;
+		release();
+		try
+		{
+			pushBlock(total);
+		}
+		catch (const std::bad_alloc&)
+		{
+		}
+		return;
+	}
+
+	if (current_ != nullptr) cursor_ = reinterpret_cast<char*>(current_ + 1);
+}
+
+void* ScratchArena::do_allocate(const std::size_t bytes, std::size_t alignment)
+{
+	alignment = std::max(alignment, ALIGNMENT);
+
+	std::size_t padding = static_cast<std::size_t>(-reinterpret_cast<std::uintptr_t>(cursor_)) & (alignment - 1);
+	if (current_ == nullptr || padding + bytes > static_cast<std::size_t>(end_ - cursor_))
+	{
+		pushBlock(bytes + alignment);
+		padding = static_cast<std::size_t>(-reinterpret_cast<std::uintptr_t>(cursor_)) & (alignment - 1);
+	}
+
+	char* pointer = cursor_ + padding;
+	cursor_ = pointer + bytes;
+	++live_allocations_;
+	return pointer;
+}
+
+void ScratchArena::do_deallocate(void* pointer, const std::size_t bytes, std::size_t /*alignment*/)
+{
+	if (--live_allocations_ == 0)
+	{
+		rewind();
+		return;
+	}
+
+	// The last allocation of the current block is given back right away, the others wait for the rewind
+	char* const begin = static_cast<char*>(pointer);
+	if (begin + bytes == cursor_ && begin >= reinterpret_cast<char*>(current_ + 1)) cursor_ = begin;
+}
+
+[[nodiscard]] ScratchArena& threadScratchArena() noexcept
+{
+	thread_local ScratchArena arena;
+	return arena;
+}
@@ -0,0 +1,59 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+/*
+*	Reusable bump allocator for the scratch arrays of one pricing call (paths, normals, uniforms, d1 / d2 columns...)
+*
+*	-.Allocations bump a pointer in the current block, a new block (twice as large) is only taken from the upstream resource when
+*	the current one is full
+*	-.Deallocations in reverse order (the scope of the containers of a call) give the memory back right away, and once nothing is
+*	alive anymore the arena rewinds to its start: if the call needed several blocks they are merged into one, so from the second call
+*	of the same size on no upstream allocation happens at all
+*	-.An arena is not thread safe, threadScratchArena() gives each thread its own
+*/
+class ScratchArena final : public std::pmr::memory_resource
+{
+public:
+	static constexpr std::size_t ALIGNMENT = 64;	// Every allocation starts on a cache line, so the vector kernels never split a load across two
+
+	explicit ScratchArena(std::size_t initial_capacity = 1 << 16, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+	~ScratchArena() override;
+
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena& operator=(const ScratchArena&) = delete;
+
+	// @release : Returns every block to the upstream resource (nothing allocated from the arena may be alive)
+	void release() noexcept;
+
+	[[nodiscard]] inline std::size_t capacity() const noexcept { return capacity_; }	// Bytes held from upstream
+	[[nodiscard]] inline std::size_t liveAllocations() const noexcept { return live_allocations_; }
+	[[nodiscard]] inline std::size_t upstreamAllocations() const noexcept { return upstream_allocations_; }	// Blocks taken since construction
+
+private:
+	struct Block
+	{
+		Block* previous;
+		std::size_t size;	// Usable bytes after the header
+	};
+
+	std::pmr::memory_resource* upstream_{};
+	Block* current_{};
+	char* cursor_{};
+	char* end_{};
+	std::size_t next_block_size_{};
+	std::size_t capacity_{};
+	std::size_t live_allocations_{};
+	std::size_t upstream_allocations_{};
+
+	void pushBlock(std::size_t size);
+	void rewind() noexcept;
+
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+	[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// @threadScratchArena : Arena of the calling thread, the default scratch resource of FinancialCalculator
+[[nodiscard]] ScratchArena& threadScratchArena() noexcept;
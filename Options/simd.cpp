@@ -0,0 +1,635 @@
+﻿#include "simd.h"
+
+#include "compact_book.h"
+
+#include <cstring>
+#include <type_traits>
+
+#if defined(__GNUC__)
+	#define FC_KERNEL_INLINE [[gnu::always_inline]] inline
+	#if defined(__x86_64__) || defined(__i386__)
+		#define FC_SIMD_X86
+	#endif
+	// The lane helpers pass wide vectors by value, they are always inlined into the per-ISA entry points so the ABI note is irrelevant
+	#pragma GCC diagnostic ignored "-Wpsabi"
+#else
+	#define FC_KERNEL_INLINE inline
+#endif
+
+namespace
+{
+	// Lane types: Lanes doubles (and the matching 64 bit integers / the Lanes floats they are widened from) processed by one operation
+	template<std::size_t Lanes>
+	struct Lane
+	{
+#if defined(__GNUC__)
+		typedef double Double __attribute__((vector_size(Lanes * sizeof(double))));
+		typedef std::int64_t Int __attribute__((vector_size(Lanes * sizeof(double))));
+		typedef float Float __attribute__((vector_size(Lanes * sizeof(float))));
+#endif
+	};
+
+	template<>
+	struct Lane<1>
+	{
+		using Double = double;
+		using Int = std::int64_t;
+		using Float = float;
+	};
+
+	constexpr double LN2_HI = 6.93147180369123816490e-01;	// ln(2) split so that k * LN2_HI is exact for every exponent k
+	constexpr double LN2_LO = 1.90821492927058770002e-10;
+	constexpr double LOG2_E = 1.44269504088896338700e+00;
+	constexpr double SQRT_2 = 1.41421356237309504880e+00;
+	constexpr double SHIFTER = 0x1.8p52;			// Adding it rounds a double to an integer that can be read back from the low mantissa bits
+	constexpr double INV_SQRT_2PI = 0.398942280401432677940;
+	constexpr double TWO_PI = 6.28318530717958647692;
+
+	template<typename To, typename From>
+	[[nodiscard]] FC_KERNEL_INLINE To bitCast(const From& from) noexcept
+	{
+		static_assert(sizeof(To) == sizeof(From), "[!] bitCast needs types of the same size");
+		To to;
+		std::memcpy(&to, &from, sizeof(To));
+		return to;
+	}
+
+	template<typename D>
+	[[nodiscard]] FC_KERNEL_INLINE D broadcast(const double value) noexcept { return D{} + value; }
+
+	template<typename D>
+	[[nodiscard]] FC_KERNEL_INLINE D load(const double* source) noexcept
+	{
+		D value;
+		std::memcpy(&value, source, sizeof(D));
+		return value;
+	}
+
+	// float32 columns (CompactOptionChain) are widened to doubles by the load itself, no double copy of them is ever written
+	template<typename D>
+	[[nodiscard]] FC_KERNEL_INLINE D load(const float* source) noexcept
+	{
+		if constexpr (std::is_same_v<D, double>)
+		{
+			return *source;
+		}
+		else
+		{
+			typename Lane<sizeof(D) / sizeof(double)>::Float value;
+			std::memcpy(&value, source, sizeof(value));
+			return __builtin_convertvector(value, D);
+		}
+	}
+
+	template<typename D>
+	FC_KERNEL_INLINE void store(double* destination, const D& value) noexcept { std::memcpy(destination, &value, sizeof(D)); }
+
+	template<typename D>
+	[[nodiscard]] FC_KERNEL_INLINE D loadSign(const OptionType* option_type) noexcept
+	{
+		if constexpr (std::is_same_v<D, double>)
+		{
+			return *option_type == OptionType::Call ? 1.0 : -1.0;
+		}
+		else
+		{
+			D sign;
+			for (std::size_t lane{ 0 }; lane < sizeof(D) / sizeof(double); ++lane)
+			{
+				sign[lane] = option_type[lane] == OptionType::Call ? 1.0 : -1.0;
+			}
+			return sign;
+		}
+	}
+
+	template<typename D>
+	[[nodiscard]] FC_KERNEL_INLINE D loadSign(const OptionChain& chain, const std::size_t i) noexcept { return loadSign<D>(&chain.option_type[i]); }
+
+	// The vector loops start on multiples of the lane count, so the bits of a full vector never straddle two words
+	template<typename D>
+	[[nodiscard]] FC_KERNEL_INLINE D loadSign(const CompactOptionChain& chain, const std::size_t i) noexcept
+	{
+		const std::uint64_t bits = chain.put_bits[i / 64] >> (i % 64);
+		if constexpr (std::is_same_v<D, double>)
+		{
+			return (bits & 1) != 0 ? -1.0 : 1.0;
+		}
+		else
+		{
+			D sign;
+			for (std::size_t lane{ 0 }; lane < sizeof(D) / sizeof(double); ++lane)
+			{
+				sign[lane] = ((bits >> lane) & 1) != 0 ? -1.0 : 1.0;
+			}
+			return sign;
+		}
+	}
+
+	template<typename D>
+	[[nodiscard]] FC_KERNEL_INLINE D sqrtLanes(const D& x) noexcept
+	{
+		if constexpr (std::is_same_v<D, double>)
+		{
+			return std::sqrt(x);
+		}
+		else
+		{
+			D root;
+			for (std::size_t lane{ 0 }; lane < sizeof(D) / sizeof(double); ++lane)
+			{
+				root[lane] = __builtin_sqrt(x[lane]);
+			}
+			return root;
+		}
+	}
+
+	// @expLanes : e^x = 2^k * e^r with k = round(x / ln(2)) and |r| <= ln(2) / 2
+	template<typename D, typename I>
+	[[nodiscard]] FC_KERNEL_INLINE D expLanes(const D& x) noexcept
+	{
+		const D clamped = x < broadcast<D>(-708.0) ? broadcast<D>(-708.0) : (x > broadcast<D>(709.0) ? broadcast<D>(709.0) : x);
+
+		const D shifted = clamped * LOG2_E + SHIFTER;
+		const D k = shifted - SHIFTER;
+		const D r = (clamped - k * LN2_HI) - k * LN2_LO;
+
+		// Taylor polynomial of e^r up to r^12 (truncation error below 2e-16 on the reduced range)
+		D polynomial = broadcast<D>(1.0 / 479001600.0);
+		polynomial = polynomial * r + 1.0 / 39916800.0;
+		polynomial = polynomial * r + 1.0 / 3628800.0;
+		polynomial = polynomial * r + 1.0 / 362880.0;
+		polynomial = polynomial * r + 1.0 / 40320.0;
+		polynomial = polynomial * r + 1.0 / 5040.0;
+		polynomial = polynomial * r + 1.0 / 720.0;
+		polynomial = polynomial * r + 1.0 / 120.0;
+		polynomial = polynomial * r + 1.0 / 24.0;
+		polynomial = polynomial * r + 1.0 / 6.0;
+		polynomial = polynomial * r + 0.5;
+		polynomial = polynomial * r + 1.0;
+		polynomial = polynomial * r + 1.0;
+
+		const I exponent = bitCast<I>(shifted) - bitCast<std::int64_t>(SHIFTER);
+		const D scale = bitCast<D>((exponent + 1023) << 52);
+
+		return x < broadcast<D>(-708.0) ? broadcast<D>(0.0) : polynomial * scale;
+	}
+
+	// @logLanes : log(x) = e * ln(2) + log(m) with m in [sqrt(1/2), sqrt(2)) and log(m) = 2 * atanh((m - 1) / (m + 1))
+	template<typename D, typename I>
+	[[nodiscard]] FC_KERNEL_INLINE D logLanes(const D& x) noexcept
+	{
+		const I bits = bitCast<I>(x);
+		I exponent = (bits >> 52) - 1023;
+		D mantissa = bitCast<D>((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+
+		const auto above_sqrt2 = mantissa > broadcast<D>(SQRT_2);
+		mantissa = above_sqrt2 ? mantissa * 0.5 : mantissa;
+		exponent = above_sqrt2 ? exponent + 1 : exponent;
+
+		const D exponent_double = bitCast<D>(exponent + bitCast<std::int64_t>(SHIFTER)) - SHIFTER;
+
+		const D s = (mantissa - 1.0) / (mantissa + 1.0);
+		const D z = s * s;
+
+		D series = broadcast<D>(1.0 / 19.0);
+		series = series * z + 1.0 / 17.0;
+		series = series * z + 1.0 / 15.0;
+		series = series * z + 1.0 / 13.0;
+		series = series * z + 1.0 / 11.0;
+		series = series * z + 1.0 / 9.0;
+		series = series * z + 1.0 / 7.0;
+		series = series * z + 1.0 / 5.0;
+		series = series * z + 1.0 / 3.0;
+		series = series * z + 1.0;
+
+		return exponent_double * LN2_HI + (2.0 * s * series + exponent_double * LN2_LO);
+	}
+
+	/*
+		@normalCdfLanes: N(x) evaluated on |x| and reflected for positive x
+		-.|x| < 4  : Hart (1968) algorithm 5666, e^(-x²/2) * P(|x|) / Q(|x|) with the coefficients given by West (2005)
+		-.|x| >= 4 : φ(x) / (|x| + 1 / (|x| + 2 / (|x| + 3 / ...))), evaluated bottom-up as a single fraction num / den
+		-.|x| > 37.5 : the tail is below the smallest normal double
+	*/
+	template<typename D, typename I>
+	[[nodiscard]] FC_KERNEL_INLINE D normalCdfLanes(const D& x) noexcept
+	{
+		const D absolute = x < broadcast<D>(0.0) ? -x : x;
+		const D exponential = expLanes<D, I>(-0.5 * absolute * absolute);
+
+		D numerator = broadcast<D>(3.52624965998911e-02);
+		numerator = numerator * absolute + 0.700383064443688;
+		numerator = numerator * absolute + 6.37396220353165;
+		numerator = numerator * absolute + 33.912866078383;
+		numerator = numerator * absolute + 112.079291497871;
+		numerator = numerator * absolute + 221.213596169931;
+		numerator = numerator * absolute + 220.206867912376;
+
+		D denominator = broadcast<D>(8.83883476483184e-02);
+		denominator = denominator * absolute + 1.75566716318264;
+		denominator = denominator * absolute + 16.064177579207;
+		denominator = denominator * absolute + 86.7807322029461;
+		denominator = denominator * absolute + 296.564248779674;
+		denominator = denominator * absolute + 637.333633378831;
+		denominator = denominator * absolute + 793.826512519948;
+		denominator = denominator * absolute + 440.413735824752;
+
+		const D rational = exponential * numerator / denominator;
+
+		D fraction_numerator = absolute;
+		D fraction_denominator = broadcast<D>(1.0);
+		for (int term{ 30 }; term >= 1; --term)
+		{
+			const D next_numerator = absolute * fraction_numerator + static_cast<double>(term) * fraction_denominator;
+			fraction_denominator = fraction_numerator;
+			fraction_numerator = next_numerator;
+		}
+		const D tail = INV_SQRT_2PI * exponential * fraction_denominator / fraction_numerator;
+
+		D lower_tail = absolute < broadcast<D>(4.0) ? rational : tail;
+		lower_tail = absolute > broadcast<D>(37.5) ? broadcast<D>(0.0) : lower_tail;
+
+		return x > broadcast<D>(0.0) ? 1.0 - lower_tail : lower_tail;
+	}
+
+	template<typename D, typename I>
+	[[nodiscard]] FC_KERNEL_INLINE D normalPdfLanes(const D& x) noexcept
+	{
+		return INV_SQRT_2PI * expLanes<D, I>(-0.5 * x * x);
+	}
+
+	/*
+		@sinCosTwoPiLanes: sin(2πu) and cos(2πu)
+		-.q = round(4u) is the quadrant and r = 2π(u - q / 4) lies in [-π/4, π/4] where both Taylor polynomials converge fast
+		-.The quadrant then rotates (cos r, sin r) by q * π/2: odd quadrants swap sine and cosine, the signs follow the quadrant
+	*/
+	template<typename D, typename I>
+	FC_KERNEL_INLINE void sinCosTwoPiLanes(const D& u, D& sine, D& cosine) noexcept
+	{
+		const D shifted = u * 4.0 + SHIFTER;
+		const I quadrant = bitCast<I>(shifted) - bitCast<std::int64_t>(SHIFTER);
+		const D r = (u - (shifted - SHIFTER) * 0.25) * TWO_PI;
+		const D r2 = r * r;
+
+		D sine_r = broadcast<D>(-1.0 / 1307674368000.0);
+		sine_r = sine_r * r2 + 1.0 / 6227020800.0;
+		sine_r = sine_r * r2 - 1.0 / 39916800.0;
+		sine_r = sine_r * r2 + 1.0 / 362880.0;
+		sine_r = sine_r * r2 - 1.0 / 5040.0;
+		sine_r = sine_r * r2 + 1.0 / 120.0;
+		sine_r = sine_r * r2 - 1.0 / 6.0;
+		sine_r = (sine_r * r2) * r + r;
+
+		D cosine_r = broadcast<D>(1.0 / 20922789888000.0);
+		cosine_r = cosine_r * r2 - 1.0 / 87178291200.0;
+		cosine_r = cosine_r * r2 + 1.0 / 479001600.0;
+		cosine_r = cosine_r * r2 - 1.0 / 3628800.0;
+		cosine_r = cosine_r * r2 + 1.0 / 40320.0;
+		cosine_r = cosine_r * r2 - 1.0 / 720.0;
+		cosine_r = cosine_r * r2 + 1.0 / 24.0;
+		cosine_r = cosine_r * r2 - 0.5;
+		cosine_r = cosine_r * r2 + 1.0;
+
+		const auto swap = (quadrant & 1) != 0;
+		const auto negate_cosine = ((quadrant + 1) & 2) != 0;
+		const auto negate_sine = (quadrant & 2) != 0;
+
+		const D rotated_cosine = swap ? sine_r : cosine_r;
+		const D rotated_sine = swap ? cosine_r : sine_r;
+		cosine = negate_cosine ? -rotated_cosine : rotated_cosine;
+		sine = negate_sine ? -rotated_sine : rotated_sine;
+	}
+
+	template<typename D, typename I>
+	FC_KERNEL_INLINE void boxMullerLanes(const double* uniforms, double* normals, const std::size_t half, const std::size_t j) noexcept
+	{
+		const D radius = sqrtLanes(-2.0 * logLanes<D, I>(1.0 - load<D>(uniforms + j)));	// 1 - u1 lies in (0, 1]
+
+		D sine, cosine;
+		sinCosTwoPiLanes<D, I>(load<D>(uniforms + half + j), sine, cosine);
+
+		store(normals + j, radius * cosine);
+		store(normals + half + j, radius * sine);
+	}
+
+	// The chain lane helpers and kernels take an OptionChain or a CompactOptionChain, only the loads differ
+	template<typename D, typename I, typename Chain>
+	FC_KERNEL_INLINE void d1d2Lanes(const Chain& chain, const std::size_t i, D& d1, D& d2) noexcept
+	{
+		const D volatility = load<D>(chain.volatility + i);
+		const D time = load<D>(chain.time + i);
+		const D volatility_sqrt_time = volatility * sqrtLanes(time);
+
+		d1 = (logLanes<D, I>(load<D>(chain.underlying_price + i) / load<D>(chain.strike_price + i)) + (load<D>(chain.interest_rate + i) + volatility * volatility * 0.5) * time) / volatility_sqrt_time;
+		d2 = d1 - volatility_sqrt_time;
+	}
+
+	// Sign trick shared with FinancialCalculator::calculateBlackScholes : price = sign * (S * N(sign * d1) - K * e^(-rT) * N(sign * d2))
+	template<typename D, typename I, typename Chain>
+	[[nodiscard]] FC_KERNEL_INLINE D blackScholesLanes(const Chain& chain, const std::size_t i) noexcept
+	{
+		D d1, d2;
+		d1d2Lanes<D, I>(chain, i, d1, d2);
+
+		const D sign = loadSign<D>(chain, i);
+		const D discount = expLanes<D, I>(-load<D>(chain.interest_rate + i) * load<D>(chain.time + i));
+
+		return sign * (load<D>(chain.underlying_price + i) * normalCdfLanes<D, I>(sign * d1) - load<D>(chain.strike_price + i) * discount * normalCdfLanes<D, I>(sign * d2));
+	}
+
+	template<typename D, typename I, typename Chain>
+	FC_KERNEL_INLINE void greeksLanes(const Chain& chain, const std::size_t i, const OptionGreeksChain& greeks) noexcept
+	{
+		const D underlying_price = load<D>(chain.underlying_price + i);
+		const D time = load<D>(chain.time + i);
+		const D volatility = load<D>(chain.volatility + i);
+		const D interest_rate = load<D>(chain.interest_rate + i);
+		const D dividend_yield = chain.dividend_yield != nullptr ? load<D>(chain.dividend_yield + i) : broadcast<D>(0.0);
+		const D sqrt_time = sqrtLanes(time);
+
+		D d1, d2;
+		d1d2Lanes<D, I>(chain, i, d1, d2);
+
+		const D sign = loadSign<D>(chain, i);
+		const D discount = expLanes<D, I>(-interest_rate * time);
+		const D dividend_discount = expLanes<D, I>(-dividend_yield * time);
+		const D cdf_d1 = normalCdfLanes<D, I>(sign * d1);
+		const D cdf_d2 = normalCdfLanes<D, I>(sign * d2);
+		const D pdf_d1 = normalPdfLanes<D, I>(d1);
+
+		const D spot_term = underlying_price * dividend_discount;
+		const D strike_term = load<D>(chain.strike_price + i) * discount;
+
+		store(greeks.price + i, sign * (spot_term * cdf_d1 - strike_term * cdf_d2));
+		store(greeks.delta + i, sign * dividend_discount * cdf_d1);
+		store(greeks.gamma + i, (dividend_discount * pdf_d1) / (underlying_price * volatility * sqrt_time));
+		store(greeks.theta + i, -(spot_term * volatility * pdf_d1) / (2.0 * sqrt_time) - sign * (interest_rate * strike_term * cdf_d2 - dividend_yield * spot_term * cdf_d1));
+		store(greeks.vega + i, spot_term * pdf_d1 * sqrt_time);
+		store(greeks.rho + i, sign * strike_term * time * cdf_d2);
+	}
+
+	// The kernels run full vectors first and finish the remainder with the very same math on single lanes
+	template<std::size_t Lanes>
+	FC_KERNEL_INLINE void normalCdfKernel(const double* x, double* out, const std::size_t size) noexcept
+	{
+		using D = typename Lane<Lanes>::Double;
+		using I = typename Lane<Lanes>::Int;
+
+		std::size_t i{ 0 };
+		for (; i + Lanes <= size; i += Lanes)
+		{
+			store(out + i, normalCdfLanes<D, I>(load<D>(x + i)));
+		}
+		for (; i < size; ++i)
+		{
+			out[i] = normalCdfLanes<double, std::int64_t>(x[i]);
+		}
+	}
+
+	template<std::size_t Lanes>
+	FC_KERNEL_INLINE void normalPdfKernel(const double* x, double* out, const std::size_t size) noexcept
+	{
+		using D = typename Lane<Lanes>::Double;
+		using I = typename Lane<Lanes>::Int;
+
+		std::size_t i{ 0 };
+		for (; i + Lanes <= size; i += Lanes)
+		{
+			store(out + i, normalPdfLanes<D, I>(load<D>(x + i)));
+		}
+		for (; i < size; ++i)
+		{
+			out[i] = normalPdfLanes<double, std::int64_t>(x[i]);
+		}
+	}
+
+	template<std::size_t Lanes>
+	FC_KERNEL_INLINE void d1d2Kernel(const OptionChain& chain, double* d1, double* d2) noexcept
+	{
+		using D = typename Lane<Lanes>::Double;
+		using I = typename Lane<Lanes>::Int;
+
+		std::size_t i{ 0 };
+		for (; i + Lanes <= chain.size; i += Lanes)
+		{
+			D d1_lanes, d2_lanes;
+			d1d2Lanes<D, I>(chain, i, d1_lanes, d2_lanes);
+			store(d1 + i, d1_lanes);
+			store(d2 + i, d2_lanes);
+		}
+		for (; i < chain.size; ++i)
+		{
+			d1d2Lanes<double, std::int64_t>(chain, i, d1[i], d2[i]);
+		}
+	}
+
+	template<std::size_t Lanes, typename Chain>
+	FC_KERNEL_INLINE void blackScholesKernel(const Chain& chain, Price* prices) noexcept
+	{
+		using D = typename Lane<Lanes>::Double;
+		using I = typename Lane<Lanes>::Int;
+
+		std::size_t i{ 0 };
+		for (; i + Lanes <= chain.size; i += Lanes)
+		{
+			store(prices + i, blackScholesLanes<D, I>(chain, i));
+		}
+		for (; i < chain.size; ++i)
+		{
+			prices[i] = blackScholesLanes<double, std::int64_t>(chain, i);
+		}
+	}
+
+	template<std::size_t Lanes, typename Chain>
+	FC_KERNEL_INLINE void greeksKernel(const Chain& chain, const OptionGreeksChain& greeks) noexcept
+	{
+		using D = typename Lane<Lanes>::Double;
+		using I = typename Lane<Lanes>::Int;
+
+		std::size_t i{ 0 };
+		for (; i + Lanes <= chain.size; i += Lanes)
+		{
+			greeksLanes<D, I>(chain, i, greeks);
+		}
+		for (; i < chain.size; ++i)
+		{
+			greeksLanes<double, std::int64_t>(chain, i, greeks);
+		}
+	}
+
+	template<std::size_t Lanes>
+	FC_KERNEL_INLINE void boxMullerKernel(const double* uniforms, double* normals, const std::size_t size) noexcept
+	{
+		using D = typename Lane<Lanes>::Double;
+		using I = typename Lane<Lanes>::Int;
+
+		const std::size_t half = size / 2;
+		std::size_t j{ 0 };
+		for (; j + Lanes <= half; j += Lanes)
+		{
+			boxMullerLanes<D, I>(uniforms, normals, half, j);
+		}
+		for (; j < half; ++j)
+		{
+			boxMullerLanes<double, std::int64_t>(uniforms, normals, half, j);
+		}
+	}
+
+	template<std::size_t Lanes>
+	FC_KERNEL_INLINE void gbmStepKernel(Price* prices, const double* normals, const std::size_t size, const double drift, const double diffusion_scale) noexcept
+	{
+		using D = typename Lane<Lanes>::Double;
+		using I = typename Lane<Lanes>::Int;
+
+		std::size_t i{ 0 };
+		for (; i + Lanes <= size; i += Lanes)
+		{
+			store(prices + i, load<D>(prices + i) * expLanes<D, I>(load<D>(normals + i) * diffusion_scale + drift));
+		}
+		for (; i < size; ++i)
+		{
+			prices[i] *= expLanes<double, std::int64_t>(normals[i] * diffusion_scale + drift);
+		}
+	}
+
+	// One entry point per instruction set, compiled with that instruction set enabled
+#if defined(FC_SIMD_X86)
+	struct Avx512Kernels
+	{
+		static constexpr InstructionSet instruction_set = InstructionSet::AVX512;
+		__attribute__((target("avx512f,avx512dq"))) static void normalCdf(const double* x, double* out, std::size_t size) noexcept { normalCdfKernel<8>(x, out, size); }
+		__attribute__((target("avx512f,avx512dq"))) static void normalPdf(const double* x, double* out, std::size_t size) noexcept { normalPdfKernel<8>(x, out, size); }
+		__attribute__((target("avx512f,avx512dq"))) static void d1d2(const OptionChain& chain, double* d1, double* d2) noexcept { d1d2Kernel<8>(chain, d1, d2); }
+		__attribute__((target("avx512f,avx512dq"))) static void blackScholes(const OptionChain& chain, Price* prices) noexcept { blackScholesKernel<8>(chain, prices); }
+		__attribute__((target("avx512f,avx512dq"))) static void greeks(const OptionChain& chain, const OptionGreeksChain& greeks) noexcept { greeksKernel<8>(chain, greeks); }
+		__attribute__((target("avx512f,avx512dq"))) static void blackScholesCompact(const CompactOptionChain& chain, Price* prices) noexcept { blackScholesKernel<8>(chain, prices); }
+		__attribute__((target("avx512f,avx512dq"))) static void greeksCompact(const CompactOptionChain& chain, const OptionGreeksChain& greeks) noexcept { greeksKernel<8>(chain, greeks); }
+		__attribute__((target("avx512f,avx512dq"))) static void boxMuller(const double* uniforms, double* normals, std::size_t size) noexcept { boxMullerKernel<8>(uniforms, normals, size); }
+		__attribute__((target("avx512f,avx512dq"))) static void gbmStep(Price* prices, const double* normals, std::size_t size, double drift, double diffusion_scale) noexcept { gbmStepKernel<8>(prices, normals, size, drift, diffusion_scale); }
+	};
+
+	struct Avx2Kernels
+	{
+		static constexpr InstructionSet instruction_set = InstructionSet::AVX2;
+		__attribute__((target("avx2,fma"))) static void normalCdf(const double* x, double* out, std::size_t size) noexcept { normalCdfKernel<4>(x, out, size); }
+		__attribute__((target("avx2,fma"))) static void normalPdf(const double* x, double* out, std::size_t size) noexcept { normalPdfKernel<4>(x, out, size); }
+		__attribute__((target("avx2,fma"))) static void d1d2(const OptionChain& chain, double* d1, double* d2) noexcept { d1d2Kernel<4>(chain, d1, d2); }
+		__attribute__((target("avx2,fma"))) static void blackScholes(const OptionChain& chain, Price* prices) noexcept { blackScholesKernel<4>(chain, prices); }
+		__attribute__((target("avx2,fma"))) static void greeks(const OptionChain& chain, const OptionGreeksChain& greeks) noexcept { greeksKernel<4>(chain, greeks); }
+		__attribute__((target("avx2,fma"))) static void blackScholesCompact(const CompactOptionChain& chain, Price* prices) noexcept { blackScholesKernel<4>(chain, prices); }
+		__attribute__((target("avx2,fma"))) static void greeksCompact(const CompactOptionChain& chain, const OptionGreeksChain& greeks) noexcept { greeksKernel<4>(chain, greeks); }
+		__attribute__((target("avx2,fma"))) static void boxMuller(const double* uniforms, double* normals, std::size_t size) noexcept { boxMullerKernel<4>(uniforms, normals, size); }
+		__attribute__((target("avx2,fma"))) static void gbmStep(Price* prices, const double* normals, std::size_t size, double drift, double diffusion_scale) noexcept { gbmStepKernel<4>(prices, normals, size, drift, diffusion_scale); }
+	};
+#endif
+
+	struct BaselineKernels
+	{
+#if defined(__GNUC__) && defined(__x86_64__)
+		static constexpr std::size_t lanes = 2;
+		static constexpr InstructionSet instruction_set = InstructionSet::SSE2;
+#elif defined(__GNUC__) && defined(__aarch64__)
+		static constexpr std::size_t lanes = 2;
+		static constexpr InstructionSet instruction_set = InstructionSet::NEON;
+#else
+		static constexpr std::size_t lanes = 1;
+		static constexpr InstructionSet instruction_set = InstructionSet::Scalar;
+#endif
+		static void normalCdf(const double* x, double* out, std::size_t size) noexcept { normalCdfKernel<lanes>(x, out, size); }
+		static void normalPdf(const double* x, double* out, std::size_t size) noexcept { normalPdfKernel<lanes>(x, out, size); }
+		static void d1d2(const OptionChain& chain, double* d1, double* d2) noexcept { d1d2Kernel<lanes>(chain, d1, d2); }
+		static void blackScholes(const OptionChain& chain, Price* prices) noexcept { blackScholesKernel<lanes>(chain, prices); }
+		static void greeks(const OptionChain& chain, const OptionGreeksChain& greeks) noexcept { greeksKernel<lanes>(chain, greeks); }
+		static void blackScholesCompact(const CompactOptionChain& chain, Price* prices) noexcept { blackScholesKernel<lanes>(chain, prices); }
+		static void greeksCompact(const CompactOptionChain& chain, const OptionGreeksChain& greeks) noexcept { greeksKernel<lanes>(chain, greeks); }
+		static void boxMuller(const double* uniforms, double* normals, std::size_t size) noexcept { boxMullerKernel<lanes>(uniforms, normals, size); }
+		static void gbmStep(Price* prices, const double* normals, std::size_t size, double drift, double diffusion_scale) noexcept { gbmStepKernel<lanes>(prices, normals, size, drift, diffusion_scale); }
+	};
+
+	struct KernelTable
+	{
+		InstructionSet instruction_set{};
+		void (*normal_cdf)(const double*, double*, std::size_t) noexcept {};
+		void (*normal_pdf)(const double*, double*, std::size_t) noexcept {};
+		void (*d1d2)(const OptionChain&, double*, double*) noexcept {};
+		void (*black_scholes)(const OptionChain&, Price*) noexcept {};
+		void (*greeks)(const OptionChain&, const OptionGreeksChain&) noexcept {};
+		void (*black_scholes_compact)(const CompactOptionChain&, Price*) noexcept {};
+		void (*greeks_compact)(const CompactOptionChain&, const OptionGreeksChain&) noexcept {};
+		void (*box_muller)(const double*, double*, std::size_t) noexcept {};
+		void (*gbm_step)(Price*, const double*, std::size_t, double, double) noexcept {};
+	};
+
+	template<typename Kernels>
+	[[nodiscard]] constexpr KernelTable makeKernelTable() noexcept
+	{
+		return { Kernels::instruction_set, &Kernels::normalCdf, &Kernels::normalPdf, &Kernels::d1d2, &Kernels::blackScholes, &Kernels::greeks,
+			&Kernels::blackScholesCompact, &Kernels::greeksCompact, &Kernels::boxMuller, &Kernels::gbmStep };
+	}
+
+	// @kernels : Picks the widest instruction set the CPU supports, once, on first use
+	[[nodiscard]] const KernelTable& kernels() noexcept
+	{
+		static const KernelTable table = []() noexcept
+		{
+#if defined(FC_SIMD_X86)
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) return makeKernelTable<Avx512Kernels>();
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return makeKernelTable<Avx2Kernels>();
+#endif
+			return makeKernelTable<BaselineKernels>();
+		}();
+
+		return table;
+	}
+}
+
+[[nodiscard]] InstructionSet activeInstructionSet() noexcept
+{
+	return kernels().instruction_set;
+}
+
+void normalCdfBatch(const double* x, double* out, std::size_t size) noexcept
+{
+	kernels().normal_cdf(x, out, size);
+}
+
+void normalPdfBatch(const double* x, double* out, std::size_t size) noexcept
+{
+	kernels().normal_pdf(x, out, size);
+}
+
+void calculateD1D2Batch(const OptionChain& chain, double* d1, double* d2) noexcept
+{
+	kernels().d1d2(chain, d1, d2);
+}
+
+void calculateBlackScholesBatch(const OptionChain& chain, Price* prices) noexcept
+{
+	kernels().black_scholes(chain, prices);
+}
+
+void calculateGreeksBatch(const OptionChain& chain, const OptionGreeksChain& greeks) noexcept
+{
+	kernels().greeks(chain, greeks);
+}
+
+void calculateBlackScholesBatch(const CompactOptionChain& chain, Price* prices) noexcept
+{
+	kernels().black_scholes_compact(chain, prices);
+}
+
+void calculateGreeksBatch(const CompactOptionChain& chain, const OptionGreeksChain& greeks) noexcept
+{
+	kernels().greeks_compact(chain, greeks);
+}
+
+void normalFromUniformBatch(const double* uniforms, double* normals, std::size_t size) noexcept
+{
+	kernels().box_muller(uniforms, normals, size);
+}
+
+void gbmStepBatch(Price* prices, const double* normals, std::size_t size, double drift, double diffusion_scale) noexcept
+{
+	kernels().gbm_step(prices, normals, size, drift, diffusion_scale);
+}
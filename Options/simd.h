@@ -0,0 +1,63 @@
+﻿#pragma once
+
+#include "options.h"
+
+/*
+*	Vectorized kernels behind the batch pricing path
+*
+*	-.The kernels are written once over generic lanes (GCC/Clang vector extensions) and compiled for several instruction sets,
+*	the best one supported by the running CPU is picked the first time any kernel is called:
+*		-. AVX-512 : 8 doubles per operation
+*		-. AVX2    : 4 doubles per operation (with FMA)
+*		-. SSE2 / NEON : 2 doubles per operation (the x86-64 and AArch64 baselines)
+*		-. Scalar  : compilers without vector extensions
+*	-.No libm call is made inside the kernels, exp and log are evaluated with range reduction plus polynomials:
+*		-. exp : Cody-Waite reduction to |r| <= ln(2)/2 and a degree 12 Taylor polynomial, a few ulps (results below e^-708 are flushed to 0)
+*		-. log : reduction to [sqrt(1/2), sqrt(2)) and the atanh series to s^19, a few ulps, only defined for positive normal inputs
+*		-. normalCdf : Hart's 5666 rational approximation for |x| < 4 and a 30 term continued fraction of the Mills ratio above it,
+*		maximum relative error measured against 0.5 * erfc(-x / sqrt(2)) is below 5e-13 over [-37.5, 37.5] (exactly 0 / 1 beyond)
+*		-. normalPdf : relative error of the vector exp (a few ulps)
+*		-. sin / cos of 2πu (Box-Muller) : quadrant reduction to |r| <= π/4 and Taylor polynomials to r^15 / r^16, a few ulps
+*/
+
+enum class InstructionSet
+{
+	Scalar,
+	SSE2,
+	NEON,
+	AVX2,
+	AVX512
+};
+
+// @activeInstructionSet : Instruction set the kernels below run with on this machine
+[[nodiscard]] InstructionSet activeInstructionSet() noexcept;
+
+// @normalCdfBatch : out[i] = N(x[i]) for i in [0, size)
+void normalCdfBatch(const double* x, double* out, std::size_t size) noexcept;
+
+// @normalPdfBatch : out[i] = φ(x[i]) for i in [0, size)
+void normalPdfBatch(const double* x, double* out, std::size_t size) noexcept;
+
+// @calculateD1D2Batch : Black-Scholes d1 and d2 of every contract in the chain, d1 and d2 must point to at least chain.size elements
+void calculateD1D2Batch(const OptionChain& chain, double* d1, double* d2) noexcept;
+
+// @calculateBlackScholesBatch : Black-Scholes price of every contract in the chain, the option types must already be validated
+void calculateBlackScholesBatch(const OptionChain& chain, Price* prices) noexcept;
+
+// @calculateGreeksBatch : Price and Greeks of every contract in the chain (same formulas as FinancialCalculator::calculateGreeks), the chain must already be validated
+void calculateGreeksBatch(const OptionChain& chain, const OptionGreeksChain& greeks) noexcept;
+
+// Same pricers over the columns of a CompactOptionBook (compact_book.h), the float32 columns are widened inside the vector loads
+struct CompactOptionChain;
+void calculateBlackScholesBatch(const CompactOptionChain& chain, Price* prices) noexcept;
+void calculateGreeksBatch(const CompactOptionChain& chain, const OptionGreeksChain& greeks) noexcept;
+
+/*
+	@normalFromUniformBatch : Box-Muller transform of a block of uniforms in [0, 1) into size standard normals (size must be even)
+	-.With h = size / 2, the pair (uniforms[j], uniforms[h + j]) becomes normals[j] = R cos(2π u2) and normals[h + j] = R sin(2π u2)
+	where R = sqrt(-2 ln(1 - u1)), so both outputs of every transform are kept and the lanes read and write contiguous memory
+*/
+void normalFromUniformBatch(const double* uniforms, double* normals, std::size_t size) noexcept;
+
+// @gbmStepBatch : One GBM step over a block of paths, prices[i] *= e^(drift + diffusion_scale * normals[i])
+void gbmStepBatch(Price* prices, const double* normals, std::size_t size, double drift, double diffusion_scale) noexcept;
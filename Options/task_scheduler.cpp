@@ -0,0 +1,222 @@
+﻿#include "task_scheduler.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+	constexpr int IDLE_SPINS = 64;	// Failed searches before a worker goes to sleep
+
+	// Worker of the calling thread (the scheduler it belongs to, nullptr outside of every pool)
+	thread_local const void* current_scheduler{ nullptr };
+	thread_local std::size_t current_worker{ 0 };
+}
+
+/*
+	Chase-Lev work-stealing deque ("Correct and Efficient Work-Stealing for Weak Memory Models", Lê et al. 2013)
+	-.The owner pushes / pops at bottom, thieves take from top with a CAS, only the last element is contended
+	-.The ring doubles when full, the previous rings are kept until the deque is destroyed since a thief may still read them
+*/
+struct TaskScheduler::Worker
+{
+	struct Ring
+	{
+		std::int64_t capacity;
+		std::unique_ptr<std::atomic<Task*>[]> slots;
+
+		explicit Ring(const std::int64_t size) : capacity(size), slots(new std::atomic<Task*>[static_cast<std::size_t>(size)]) {}
+
+		[[nodiscard]] Task* get(const std::int64_t index) const noexcept { return slots[static_cast<std::size_t>(index & (capacity - 1))].load(std::memory_order_relaxed); }
+		void put(const std::int64_t index, Task* task) noexcept { slots[static_cast<std::size_t>(index & (capacity - 1))].store(task, std::memory_order_relaxed); }
+	};
+
+	alignas(64) std::atomic<std::int64_t> top{ 0 };
+	alignas(64) std::atomic<std::int64_t> bottom{ 0 };
+	std::atomic<Ring*> ring{ nullptr };
+	std::vector<std::unique_ptr<Ring>> rings{};	// Every ring ever used, owned by the worker
+	std::thread thread{};
+
+	Worker()
+	{
+		rings.push_back(std::make_unique<Ring>(256));
+		ring.store(rings.back().get(), std::memory_order_relaxed);
+	}
+
+	// @push : Owner only
+	void push(Task* task)
+	{
+		const std::int64_t b = bottom.load(std::memory_order_relaxed);
+		const std::int64_t t = top.load(std::memory_order_acquire);
+		Ring* current = ring.load(std::memory_order_relaxed);
+
+		if (b - t > current->capacity - 1)
+		{
+			auto grown = std::make_unique<Ring>(2 * current->capacity);
+			for (std::int64_t i{ t }; i < b; ++i)
+			{
+				grown->put(i, current->get(i));
+			}
+			current = grown.get();
+			rings.push_back(std::move(grown));
+			ring.store(current, std::memory_order_release);
+		}
+
+		current->put(b, task);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	// @pop : Owner only, newest task first
+	[[nodiscard]] Task* pop() noexcept
+	{
+		const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		Ring* current = ring.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t t = top.load(std::memory_order_relaxed);
+
+		if (t > b)
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Task* task = current->get(b);
+		if (t == b)
+		{
+			// Last task, race the thieves for it
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) task = nullptr;
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return task;
+	}
+
+	// @steal : Any thread, oldest task first
+	[[nodiscard]] Task* steal() noexcept
+	{
+		std::int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const std::int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b) return nullptr;
+
+		Task* task = ring.load(std::memory_order_acquire)->get(t);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+		return task;
+	}
+};
+
+TaskScheduler::TaskScheduler(std::size_t number_of_workers)
+{
+	number_of_workers = number_of_workers != 0 ? number_of_workers : std::max(1u, std::thread::hardware_concurrency());
+
+	workers_.reserve(number_of_workers);
+	for (std::size_t i{ 0 }; i < number_of_workers; ++i)
+	{
+		workers_.push_back(std::make_unique<Worker>());
+	}
+	for (std::size_t i{ 0 }; i < number_of_workers; ++i)
+	{
+		workers_[i]->thread = std::thread([this, i] { run(i); });
+	}
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	{
+		const std::lock_guard<std::mutex> lock(sleep_mutex_);
+		stopping_.store(true);
+	}
+	wake_.notify_all();
+
+	for (auto& worker : workers_)
+	{
+		worker->thread.join();
+	}
+}
+
+[[nodiscard]] TaskScheduler& TaskScheduler::shared()
+{
+	static TaskScheduler scheduler;
+	return scheduler;
+}
+
+void TaskScheduler::push(Task* task)
+{
+	if (current_scheduler == this)
+	{
+		workers_[current_worker]->push(task);
+	}
+	else
+	{
+		const std::lock_guard<std::mutex> lock(injection_mutex_);
+		injection_.push_back(task);
+	}
+
+	// Pairs with the sleeping_ / queued_ order of run(): either the pusher sees the sleeper, or the sleeper sees the task
+	queued_.fetch_add(1);
+	if (sleeping_.load() != 0)
+	{
+		const std::lock_guard<std::mutex> lock(sleep_mutex_);
+		wake_.notify_one();
+	}
+}
+
+// @take : Own deque first, then the injection queue, then steal from the other workers starting after this one
+[[nodiscard]] TaskScheduler::Task* TaskScheduler::take(const std::size_t worker) noexcept
+{
+	if (Task* task = workers_[worker]->pop()) return task;
+
+	{
+		const std::lock_guard<std::mutex> lock(injection_mutex_);
+		if (!injection_.empty())
+		{
+			Task* task = injection_.front();
+			injection_.pop_front();
+			return task;
+		}
+	}
+
+	for (std::size_t i{ 1 }; i < workers_.size(); ++i)
+	{
+		if (Task* task = workers_[(worker + i) % workers_.size()]->steal()) return task;
+	}
+	return nullptr;
+}
+
+void TaskScheduler::run(const std::size_t worker) noexcept
+{
+	current_scheduler = this;
+	current_worker = worker;
+
+	int idle{ 0 };
+	while (true)
+	{
+		if (Task* task = take(worker))
+		{
+			queued_.fetch_sub(1);
+			{
+				FC_METRICS_SCOPE(SchedulerTask);
+				task->run();
+			}
+			delete task;
+			idle = 0;
+			continue;
+		}
+
+		// Every task submitted before the stop has been taken once queued_ drops to 0
+		if (stopping_.load() && queued_.load() == 0) break;
+
+		if (++idle < IDLE_SPINS)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		sleeping_.fetch_add(1);
+		wake_.wait(lock, [this] { return queued_.load() != 0 || stopping_.load(); });
+		sleeping_.fetch_sub(1);
+		idle = 0;
+	}
+}
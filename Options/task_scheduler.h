@@ -0,0 +1,90 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+*	Work-stealing task scheduler for heterogeneous pricing jobs (microsecond closed forms next to multi-second simulations)
+*
+*	-.Every worker owns a lock-free Chase-Lev deque: it pushes and pops its own tasks at the bottom (LIFO, cache friendly), idle workers
+*	steal from the top of the others (FIFO, the oldest and usually largest pieces of work)
+*	-.Tasks submitted from outside the pool go through a shared injection queue, tasks submitted from a task go to the deque of its worker
+*	-.Idle workers spin briefly, then sleep until new work is submitted
+*	-.A task must not block on the future of another task (the chunks of a job are independent tasks, the last one finishes the job)
+*	-.The destructor runs every task already submitted, then joins the workers
+*/
+class TaskScheduler
+{
+public:
+	explicit TaskScheduler(std::size_t number_of_workers = 0);	// 0 uses every hardware thread
+	~TaskScheduler();
+
+	TaskScheduler(const TaskScheduler&) = delete;
+	TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return workers_.size(); }
+
+	// @submit : Runs function() on a worker, its result (or exception) is delivered through the future
+	template<typename Function>
+	[[nodiscard]] std::future<std::invoke_result_t<std::decay_t<Function>>> submit(Function&& function)
+	{
+		using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+		std::packaged_task<Result()> task(std::forward<Function>(function));
+		std::future<Result> future = task.get_future();
+		schedule(std::move(task));
+		return future;
+	}
+
+	// @schedule : Runs function() on a worker without a future, it must not throw (std::terminate is called otherwise)
+	template<typename Function>
+	void schedule(Function&& function)
+	{
+		push(new FunctionTask<std::decay_t<Function>>(std::forward<Function>(function)));
+	}
+
+	// @shared : Process wide scheduler over every hardware thread, created on first use
+	[[nodiscard]] static TaskScheduler& shared();
+
+private:
+	struct Task
+	{
+		virtual ~Task() = default;
+		virtual void run() noexcept = 0;
+	};
+
+	template<typename Function>
+	struct FunctionTask final : Task
+	{
+		Function function;
+
+		explicit FunctionTask(Function&& body) : function(std::move(body)) {}
+		explicit FunctionTask(const Function& body) : function(body) {}
+
+		void run() noexcept override { function(); }
+	};
+
+	struct Worker;
+
+	std::vector<std::unique_ptr<Worker>> workers_{};
+	std::mutex injection_mutex_{};
+	std::deque<Task*> injection_{};		// Tasks submitted from outside of the pool
+	std::mutex sleep_mutex_{};
+	std::condition_variable wake_{};
+	std::atomic<std::size_t> queued_{ 0 };	// Tasks pushed and not taken yet
+	std::atomic<std::size_t> sleeping_{ 0 };
+	std::atomic<bool> stopping_{ false };
+
+	void push(Task* task);
+	[[nodiscard]] Task* take(std::size_t worker) noexcept;
+	void run(std::size_t worker) noexcept;
+};